@@ -0,0 +1,31 @@
+QT += core
+QT -= gui
+
+CONFIG += c++11
+
+macx {
+    QMAKE_MAC_SDK = macosx10.11
+    QMAKE_CXXFLAGS  += -Wno-inconsistent-missing-override
+}
+
+TARGET = bruteforce_bench
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../src
+
+SOURCES += \
+    src/main.cpp \
+    ../src/candidategenerator.cpp \
+    ../src/hashkernels.cpp \
+    ../src/hashkernels_avx2.cpp \
+    ../src/hashkernels_avx512.cpp \
+    ../src/hashkernels_scalar.cpp \
+    ../src/hashkernels_sse41.cpp
+
+HEADERS += \
+    ../src/candidategenerator.h \
+    ../src/hashkernels.h \
+    ../src/hashkernels_impl.h
@@ -0,0 +1,189 @@
+#include "candidategenerator.h"
+#include "hashkernels.h"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QString>
+#include <set>
+#include <iostream>
+
+/*
+ *  Banc de mesure du générateur de candidats du plugin bruteforce.
+ *
+ *  Usage : bruteforce_bench [<charset> [<length>]]
+ *
+ *  Chaque moteur énumère tout l'espace de clés de la longueur donnée en hachant
+ *  chaque candidat en md5 contre une cible qui ne correspond jamais, puis le
+ *  débit est affiché en candidats par seconde.
+ *
+ *  Le débit brut de chaque algorithme disposant de noyaux multi-voies (md5, sha1,
+ *  sha256) est ensuite mesuré pour QCryptographicHash et pour chaque noyau supporté
+ *  par le processeur, sur des messages de la longueur donnée.
+ */
+
+#define DEFAULT_CHARSET "abcdefghijklmnopqrstuvwxyz0123456789"
+#define DEFAULT_LENGTH  4
+#define NEVER_MATCH     "00000000000000000000000000000000"
+#define KERNEL_HASHES   (1 << 21)   // empreintes calculées par mesure de débit brut
+
+// -- ancien moteur récursif (copie conforme de Computer::bruteForceRecursif avant l'odomètre)
+
+static quint64 legacyCount = 0;
+
+static bool legacyRecursif(std::set<QChar> charset, QString prefixe, uint longueur, uint longueur_max, QString target)
+{
+    if(longueur == longueur_max)
+    {
+        for(std::set<QChar>::iterator charIter = charset.begin(); charIter != charset.end(); ++charIter)
+        {
+            prefixe.replace(longueur_max - 1, 1, *charIter);
+            QString hashed = QCryptographicHash::hash(prefixe.toUtf8(), QCryptographicHash::Md5).toHex();
+            legacyCount++;
+            if(QString::compare(target, hashed, Qt::CaseInsensitive) == 0)
+            {   return true;
+            }
+        }
+        return false;
+    }
+    else
+    {
+        for(std::set<QChar>::iterator charIter = charset.begin(); charIter != charset.end(); ++charIter)
+        {   prefixe.replace(longueur - 1, 1, *charIter);
+            if(legacyRecursif(charset, prefixe, longueur + 1, longueur_max, target)) return true;
+        }
+        return false;
+    }
+}
+
+static quint64 runLegacy(const QString & charset, uint length)
+{
+    std::set<QChar> characters;
+    for(int i = 0; i < charset.length(); i++)
+    {   characters.insert(charset.at(i));
+    }
+    QString root = "";
+    for(uint i=0; i<length; i++)
+    {   root += *(characters.begin());
+    }
+    legacyCount = 0;
+    legacyRecursif(characters, root, 1, length, NEVER_MATCH);
+    return legacyCount;
+}
+
+// -- nouveau moteur : odomètre sur tampon fixe
+
+static quint64 runOdometer(const QString & charset, uint length)
+{
+    // même jeu à plat que Keyspace : caractères triés, chacun encodé en UTF-8
+    QByteArray flat;
+    std::set<QChar> characters;
+    for(int i = 0; i < charset.length(); i++)
+    {   characters.insert(charset.at(i));
+    }
+    for(std::set<QChar>::iterator c = characters.begin(); c != characters.end(); ++c)
+    {   flat.append(QString(*c).toUtf8());
+    }
+    quint64 count = 0;
+    QString target(NEVER_MATCH);
+    CandidateGenerator generator(flat, length);
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    do
+    {   hash.reset();
+        hash.addData(generator.data(), generator.length());
+        QString hashed = hash.result().toHex();
+        count++;
+        if(QString::compare(target, hashed, Qt::CaseInsensitive) == 0)
+        {   break;
+        }
+    }
+    while(generator.next());
+    return count;
+}
+
+// -- débit brut des fonctions de hachage
+
+static quint64 runQtHash(QCryptographicHash::Algorithm algorithm, const QByteArray & message)
+{
+    QCryptographicHash hash(algorithm);
+    quint64 sink = 0;
+    for(int i = 0; i < KERNEL_HASHES; i++)
+    {   hash.reset();
+        hash.addData(message);
+        sink += (uchar)hash.result().at(0);
+    }
+    return sink;
+}
+
+static quint64 runKernel(HashBatchFunction function, int lanes, const QByteArray & message)
+{
+    const unsigned char * msgs[HASH_KERNEL_MAX_LANES];
+    int lens[HASH_KERNEL_MAX_LANES];
+    unsigned char digests[HASH_KERNEL_MAX_LANES * HASH_KERNEL_MAX_DIGEST_LEN];
+    for(int lane = 0; lane < lanes; lane++)
+    {   msgs[lane] = (const unsigned char *)message.constData();
+        lens[lane] = message.size();
+    }
+    quint64 sink = 0;
+    for(int i = 0; i < KERNEL_HASHES; i += lanes)
+    {   function(msgs, lens, digests);
+        sink += digests[0];
+    }
+    return sink;
+}
+
+static void report(const char * name, quint64 count, qint64 elapsedMs, const char * unit = "candidates")
+{
+    double rate = elapsedMs > 0 ? (count * 1000.0) / elapsedMs : 0.0;
+    std::cout << name << " : " << count << " " << unit << " in " << elapsedMs << " ms -> "
+              << (quint64)rate << " " << unit << "/s" << std::endl;
+}
+
+static void benchKernels(uint length)
+{
+    struct { const char * name; QCryptographicHash::Algorithm algorithm; } algorithms[] = {
+        { "md5",    QCryptographicHash::Md5 },
+        { "sha1",   QCryptographicHash::Sha1 },
+        { "sha256", QCryptographicHash::Sha256 }
+    };
+    QByteArray message((int)qMin(length, (uint)HASH_KERNEL_MAX_MSG_LEN), 'a');
+    int count;
+    const HashKernel * const * kernels = SupportedHashKernels(&count);
+
+    std::cout << "raw hash throughput, message length=" << message.size() << std::endl;
+    for(int a = 0; a < 3; a++)
+    {   QElapsedTimer timer;
+        timer.start();
+        runQtHash(algorithms[a].algorithm, message);
+        report(QString("%1 %2").arg(algorithms[a].name, -6).arg("qt", -7).toLatin1().constData(),
+               KERNEL_HASHES, timer.elapsed(), "hashes");
+
+        for(int k = 0; k < count; k++)
+        {   HashBatchFunction function = a == 0 ? kernels[k]->md5 : a == 1 ? kernels[k]->sha1 : kernels[k]->sha256;
+            timer.restart();
+            runKernel(function, kernels[k]->lanes, message);
+            report(QString("%1 %2").arg(algorithms[a].name, -6).arg(kernels[k]->name, -7).toLatin1().constData(),
+                   KERNEL_HASHES, timer.elapsed(), "hashes");
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QString charset = QString::fromUtf8(argc > 1 ? argv[1] : DEFAULT_CHARSET);
+    uint length = argc > 2 ? QString(argv[2]).toUInt() : DEFAULT_LENGTH;
+
+    std::cout << "charset=" << charset.toStdString() << " length=" << length << " hash=md5" << std::endl;
+
+    QElapsedTimer timer;
+    timer.start();
+    quint64 count = runLegacy(charset, length);
+    report("before (recursive)", count, timer.elapsed());
+
+    timer.restart();
+    count = runOdometer(charset, length);
+    report("after  (odometer) ", count, timer.elapsed());
+
+    benchKernels(length);
+
+    return EXIT_SUCCESS;
+}
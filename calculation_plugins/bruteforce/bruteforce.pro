@@ -15,13 +15,32 @@ CONFIG -= app_bundle
 TEMPLATE = app
 
 SOURCES += \
+    src/bencher.cpp \
+    src/candidategenerator.cpp \
     src/computer.cpp \
+    src/hashkernels.cpp \
+    src/hashkernels_avx2.cpp \
+    src/hashkernels_avx512.cpp \
+    src/hashkernels_scalar.cpp \
+    src/hashkernels_sse41.cpp \
     src/joiner.cpp \
+    src/keyspace.cpp \
+    src/keyspacescheduler.cpp \
     src/main.cpp \
-    src/splitter.cpp
+    src/splitter.cpp \
+    src/targetset.cpp \
+    src/wordlist.cpp
 
 HEADERS += \
+    src/bencher.h \
     src/bruteforce_specs.h \
+    src/candidategenerator.h \
     src/computer.h \
+    src/hashkernels.h \
+    src/hashkernels_impl.h \
     src/joiner.h \
-    src/splitter.h
+    src/keyspace.h \
+    src/keyspacescheduler.h \
+    src/splitter.h \
+    src/targetset.h \
+    src/wordlist.h
@@ -0,0 +1,57 @@
+#include "bencher.h"
+#include "computer.h"
+#include "../../server/src/calculation/specs.h"
+#include "bruteforce_specs.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVariantMap>
+
+#define BENCH_DURATION_MS   500     // durée de la mesure pour chaque algorithme
+
+bool Bencher::bench(const QString &json)
+{
+    // -- les paramètres sont optionnels : un algorithme précis et/ou un nombre de threads
+    QVariantMap params;
+    if(!json.trimmed().isEmpty())
+    {   QJsonParseError error;
+        QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &error);
+        if(error.error || !doc.isObject())
+        {   _error = "Missing json object !";
+            return false;
+        }
+        params = doc.object().value(CS_JSON_KEY_CALC_PARAMS).toObject().toVariantMap();
+    }
+    QStringList algorithms;
+    if(params.contains(PARAM_HASH_F))
+    {   algorithms << params.value(PARAM_HASH_F).toString().toLower();
+    }
+    else
+    {   algorithms << "md4" << "md5" << "sha1" << "sha224" << "sha256" << "sha384" << "sha512"
+                   << "sha3_224" << "sha3_256" << "sha3_384" << "sha3_512";
+    }
+    int threads = params.value(PARAM_THREADS, 0).toInt();
+
+    // -- une courte recherche chronométrée par algorithme, avec le moteur de calcul réel
+    QJsonObject rates;
+    foreach(const QString & algorithm, algorithms)
+    {   Computer computer;
+        double rate;
+        if(!computer.measure(algorithm, threads, BENCH_DURATION_MS, rate))
+        {   _error = computer.error();
+            return false;
+        }
+        rates.insert(algorithm, (qint64)rate);
+    }
+    QJsonObject response;
+    response.insert(PARAM_HASH_RATE, rates);
+    _result = QJsonDocument(response).toJson(QJsonDocument::Compact);
+    return true;
+}
+
+Bencher::Bencher() :
+    _error(""),
+    _result("")
+{
+}
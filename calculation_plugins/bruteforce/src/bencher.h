@@ -0,0 +1,21 @@
+#ifndef BENCHER_H
+#define BENCHER_H
+
+#include <QString>
+
+class Bencher
+{
+public:
+    Bencher();
+
+    bool bench(const QString &json);
+    inline QString error() const { return _error; }
+    inline QString result() const { return _result; }
+
+private:
+    QString _error;
+    QString _result;
+
+};
+
+#endif // BENCHER_H
@@ -2,11 +2,21 @@
 #define BRUTEFORCE_SPECS_H
 
 #define PARAM_CHARSET   "charset"
+#define PARAM_MASK      "mask"
+#define PARAM_WORDLIST  "wordlist"
 #define PARAM_MIN_LEN   "min_len"
 #define PARAM_MAX_LEN   "max_len"
 #define PARAM_HASH_F    "hash_func"
 #define PARAM_TARGET    "target"
+#define PARAM_TARGET_FILE   "file"
+#define PARAM_THREADS   "threads"
+#define PARAM_START_INDEX   "start_index"
+#define PARAM_END_INDEX     "end_index"
+#define PARAM_FRAG_COUNT    "fragment_count"
+#define PARAM_FRAG_SIZE     "fragment_size"
+#define PARAM_HASH_RATE     "hash_rate"
 #define PARAM_HAS_MATCH "has_match"
 #define PARAM_MATCH_STR "match_str"
+#define PARAM_MATCHES   "matches"
 
 #endif // BRUTEFORCE_SPECS_H
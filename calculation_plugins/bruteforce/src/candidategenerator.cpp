@@ -0,0 +1,134 @@
+#include "candidategenerator.h"
+
+#include <string.h>
+
+/**
+ * @brief Indique si l'octet continue un symbole UTF-8 commencé avant lui
+ */
+static inline bool isContinuation(char byte)
+{
+    return ((uchar)byte & 0xC0) == 0x80;
+}
+
+CandidateGenerator::CandidateGenerator(const QByteArray &charset, int length) :
+    _positions(length, charset)
+{
+    init();
+}
+
+CandidateGenerator::CandidateGenerator(const QVector<QByteArray> &positions) :
+    _positions(positions)
+{
+    init();
+}
+
+int CandidateGenerator::SymbolCount(const QByteArray &symbols)
+{
+    int count = 0;
+    for(int i = 0; i < symbols.size(); ++i)
+    {   if(!isContinuation(symbols.at(i))) count++;
+    }
+    return count;
+}
+
+int CandidateGenerator::WidestSymbol(const QByteArray &symbols)
+{
+    int widest = 0;
+    for(int i = 0; i < symbols.size(); )
+    {   int length = 1;
+        while(i + length < symbols.size() && isContinuation(symbols.at(i + length))) length++;
+        widest = qMax(widest, length);
+        i += length;
+    }
+    return widest;
+}
+
+void CandidateGenerator::init()
+{
+    _count = _positions.size();
+    _single_byte = true;
+    _indexes.fill(0, _count);
+    _starts.fill(0, _count);
+    _position_symbols.resize(_count);
+    _radixes.resize(_count);
+    _tables.resize(_count);
+    _position_tables.resize(_count);
+    // table des symboles de chaque position, le tampon peut contenir le plus long candidat
+    int capacity = 0;
+    for(int pos = 0; pos < _count; ++pos)
+    {   const QByteArray & symbols = _positions.at(pos);
+        QVector<Symbol> & table = _tables[pos];
+        int widest = 0;
+        for(int i = 0; i < symbols.size(); )
+        {   Symbol symbol = { i, 1 };
+            while(i + symbol.length < symbols.size() && isContinuation(symbols.at(i + symbol.length))) symbol.length++;
+            table.append(symbol);
+            widest = qMax(widest, symbol.length);
+            i += symbol.length;
+        }
+        if(table.size() != symbols.size()) _single_byte = false;
+        _position_symbols[pos] = symbols.constData();
+        _radixes[pos] = table.size();
+        _position_tables[pos] = table.constData();
+        capacity += widest;
+    }
+    _buffer.resize(capacity);
+    _symbols = _position_symbols.constData();
+    _table = _position_tables.constData();
+    _candidate = _buffer.data();
+    _digits = _indexes.data();
+    _start = _starts.data();
+    _radix = _radixes.constData();
+    _length = _count;
+    reset();
+}
+
+void CandidateGenerator::reset()
+{
+    for(int pos = 0; pos < _count; ++pos)
+    {   _digits[pos] = 0;
+        if(_single_byte) _candidate[pos] = _symbols[pos][0];
+    }
+    if(!_single_byte) rewrite(0);
+}
+
+void CandidateGenerator::seek(quint64 index)
+{
+    // décomposition du rang en base mixte, le dernier caractère étant le chiffre de poids faible
+    for(int pos = _count - 1; pos >= 0; --pos)
+    {   int digit = (int)(index % _radix[pos]);
+        index /= _radix[pos];
+        _digits[pos] = digit;
+        if(_single_byte) _candidate[pos] = _symbols[pos][digit];
+    }
+    if(!_single_byte) rewrite(0);
+}
+
+bool CandidateGenerator::nextSymbol()
+{
+    // position qui avance, les suivantes reviennent à leur premier symbole
+    int pos = _count - 1;
+    while(pos >= 0 && _digits[pos] + 1 == _radix[pos])
+    {   _digits[pos] = 0;
+        --pos;
+    }
+    if(pos < 0)
+    {   rewrite(0);
+        return false;
+    }
+    _digits[pos]++;
+    rewrite(pos);
+    return true;
+}
+
+void CandidateGenerator::rewrite(int from)
+{
+    int offset = _start[from];
+    for(int pos = from; pos < _count; ++pos)
+    {   const Symbol & symbol = _table[pos][_digits[pos]];
+        _start[pos] = offset;
+        memcpy(_candidate + offset, _symbols[pos] + symbol.offset, symbol.length);
+        offset += symbol.length;
+    }
+    _length = offset;
+}
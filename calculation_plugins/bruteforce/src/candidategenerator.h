@@ -0,0 +1,129 @@
+#ifndef CANDIDATEGENERATOR_H
+#define CANDIDATEGENERATOR_H
+
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief Cette classe énumère tous les candidats d'une longueur donnée, chaque position ayant
+ * son propre jeu de caractères (un seul jeu pour toutes les positions ou un masque).
+ *
+ * L'énumération fonctionne comme un compteur kilométrique : le dernier caractère varie le plus
+ * vite et seuls les octets qui changent sont réécrits dans un tampon de taille fixe. Aucune
+ * allocation n'a lieu une fois le générateur construit.
+ *
+ * Un symbole est un caractère encodé en UTF-8 : chaque position dispose d'une table des symboles
+ * (début, longueur) dans son jeu à plat. Quand tous les symboles font un octet, la table n'est
+ * pas consultée et chaque changement de symbole réécrit un seul octet.
+ */
+class CandidateGenerator
+{
+public:
+    /**
+     * @brief Construit un générateur positionné sur le premier candidat
+     * @param charset
+     *      Jeu de caractères à plat, symboles UTF-8 mis bout à bout, triés et sans doublon
+     * @param length
+     *      Longueur des candidats à énumérer
+     */
+    CandidateGenerator(const QByteArray & charset, int length);
+    /**
+     * @brief Construit un générateur positionné sur le premier candidat
+     * @param positions
+     *      Jeu de caractères de chaque position, symboles UTF-8 mis bout à bout, triés et sans doublon
+     */
+    CandidateGenerator(const QVector<QByteArray> & positions);
+    ~CandidateGenerator(){}
+
+    /**
+     * @brief Retourne le nombre de symboles UTF-8 d'un jeu de caractères à plat
+     */
+    static int SymbolCount(const QByteArray & symbols);
+
+    /**
+     * @brief Retourne la longueur en octets du plus long symbole d'un jeu de caractères à plat
+     */
+    static int WidestSymbol(const QByteArray & symbols);
+
+    /**
+     * @brief Retourne le candidat courant (non terminé par '\0')
+     */
+    inline const char * data() const { return _candidate; }
+
+    /**
+     * @brief Retourne la longueur du candidat courant en octets
+     */
+    inline int length() const { return _length; }
+
+    /**
+     * @brief Replace le générateur sur le premier candidat
+     */
+    void reset();
+
+    /**
+     * @brief Positionne le générateur sur le candidat de rang index (le premier candidat a le rang 0)
+     */
+    void seek(quint64 index);
+
+    /**
+     * @brief Passe au candidat suivant
+     * @return faux si tous les candidats ont été énumérés
+     */
+    inline bool next()
+    {
+        if(!_single_byte) return nextSymbol();
+        for(int pos = _count - 1; pos >= 0; --pos)
+        {   int digit = _digits[pos] + 1;
+            if(digit < _radix[pos])
+            {   _digits[pos] = digit;
+                _candidate[pos] = _symbols[pos][digit];
+                return true;
+            }
+            // retenue : la position revient au premier symbole
+            _digits[pos] = 0;
+            _candidate[pos] = _symbols[pos][0];
+        }
+        return false;
+    }
+
+private:
+    Q_DISABLE_COPY(CandidateGenerator)
+
+    struct Symbol {
+        int offset;     ///< Premier octet du symbole dans le jeu à plat de sa position
+        int length;     ///< Longueur du symbole en octets
+    };
+
+    QVector<QByteArray> _positions;
+    QByteArray _buffer;
+    QVector<int> _indexes;
+    QVector<const char *> _position_symbols;
+    QVector<int> _radixes;
+    QVector< QVector<Symbol> > _tables;
+    QVector<const Symbol *> _position_tables;
+    QVector<int> _starts;
+    // accès directs aux données des conteneurs ci-dessus pour la boucle chaude
+    const char * const * _symbols;
+    const Symbol * const * _table;
+    char * _candidate;
+    int * _digits;
+    int * _start;
+    const int * _radix;
+    // nombre de positions et longueur du candidat courant en octets
+    int _count;
+    int _length;
+    bool _single_byte;
+
+    void init();
+    /**
+     * @brief Passe au candidat suivant quand des symboles font plusieurs octets
+     */
+    bool nextSymbol();
+    /**
+     * @brief Réécrit les symboles à partir d'une position, les suivantes étant décalées
+     *      si la longueur en octets change
+     */
+    void rewrite(int from);
+};
+
+#endif // CANDIDATEGENERATOR_H
@@ -1,11 +1,45 @@
 #include "computer.h"
+#include "candidategenerator.h"
+#include "keyspacescheduler.h"
 #include "../../server/src/calculation/specs.h"
 #include "bruteforce_specs.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QVariantMap>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutexLocker>
 #include <iostream>
+#include <string.h>
+
+#define SEARCH_CHUNK    65536   // candidats traités entre deux consultations de l'ordonnanceur
+#define BENCH_CHARSET   "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+#define BENCH_LENGTH    8       // longueur typique, l'espace de clés est inépuisable pendant la mesure
+#define PROGRESS_PERIOD 1000    // ms entre deux lignes d'avancement
+#define DIGEST_MAX_LEN  64      // octets, empreinte la plus longue (sha512, sha3_512)
+#define THREADS_PER_CORE_MAX 4  // au delà, les threads imposés ne font que se disputer les coeurs
+
+/**
+ * @brief Tâche exécutée par chacun des threads de recherche
+ */
+class SearchTask : public QRunnable
+{
+public:
+    SearchTask(Computer * computer, int worker) :
+        _computer(computer),
+        _worker(worker)
+    {}
+
+    void run() { _computer->search(_worker); }
+
+private:
+    Computer * _computer;
+    int _worker;
+};
 
 bool Computer::compute(const QString &json)
 {
@@ -20,32 +54,42 @@ bool Computer::compute(const QString &json)
         {   params = doc.object().value(CS_JSON_KEY_CALC_PARAMS).toObject().toVariantMap();
 
             // récupération des paramètres du calcul
-            QString charset = params.value(PARAM_CHARSET).toString();
-            uint minLen = params.value(PARAM_MIN_LEN).toInt();
-            uint maxLen = params.value(PARAM_MAX_LEN).toInt();
             QString hashFunction = params.value(PARAM_HASH_F).toString();
-            QString target = params.value(PARAM_TARGET).toString();
+            QVariant target = params.value(PARAM_TARGET);
+            int threads = decideThreads(params.value(PARAM_THREADS, 0).toInt());
 
             // récupération de l'algo de hashage
             if(!decideHashAlgorithm(hashFunction)) return false;
 
-            // génération du jeu de charactères
-            std::set<QChar> characters;
-            if(!possibleCharacters(&characters, charset)) return false;
+            // décodage des empreintes cibles, leur taille dépend de l'algo
+            if(!decodeTarget(target)) return false;
 
-            // calcul brute force
-            bool matchFound = false;
-            for(uint i=minLen; i<=maxLen && !matchFound; i++)
-            {   matchFound = bruteForce(characters, i, target);
-            }
+            // candidats du fragment : intervalle de l'espace de clés ou du fichier de mots
+            if(!decideCandidates(params)) return false;
+
+            // correspondances trouvées avant un point de reprise
+            restoreMatches(params);
+
+            // calcul brute force, inutile si le point de reprise contient déjà toutes les cibles
+            bool matchFound = _matches.size() < _targets.count() ? bruteForce(threads) : true;
 
             // construction de la réponse
             QVariantMap mapResult;
             mapResult.insert(PARAM_HAS_MATCH, matchFound);
             mapResult.insert(PARAM_MATCH_STR, _match_string);
+            QVariantList matches;
+            for(QMap<QByteArray, QString>::const_iterator it = _matches.constBegin(); it != _matches.constEnd(); ++it)
+            {   QVariantMap match;
+                match.insert(PARAM_TARGET, QString(it.key().toHex()));
+                match.insert(PARAM_MATCH_STR, it.value());
+                matches.append(match);
+            }
+            mapResult.insert(PARAM_MATCHES, matches);
             QVariantMap mapResponse;
             mapResponse.insert(CS_JSON_KEY_FRAG_ID, (doc.object())[CS_JSON_KEY_FRAG_ID].toString());
             mapResponse.insert(CS_JSON_KEY_CALC_RESULT, mapResult);
+            // toutes les cibles trouvées : le serveur peut arrêter les autres fragments
+            mapResponse.insert(CS_JSON_KEY_FRAG_FINAL, !_matches.isEmpty() && _matches.size() == _targets.count());
             QJsonDocument response(QJsonObject::fromVariantMap(mapResponse));
             _result = response.toJson();
 
@@ -68,78 +112,415 @@ bool Computer::compute(const QString &json)
 Computer::Computer() :
     _error(""),
     _result(""),
-    _match_string("")
+    _match_string(""),
+    _match_found(false),
+    _match_index(0),
+    _batch_hash(NULL),
+    _batch_lanes(1),
+    _message_hash(NULL),
+    _targets(),
+    _matches(),
+    _digest_length(0),
+    _keyspace(),
+    _wordlist(),
+    _wordlist_mode(false),
+    _words_end(0),
+    _start_index(0),
+    _end_index(0),
+    _scheduler(NULL),
+    _stop(0),
+    _tested(0)
 {
 }
 
 
-bool Computer::bruteForce(std::set<QChar> charset, uint length, QString target)
+bool Computer::measure(const QString &hashFunction, int threads, int durationMs, double &rate)
 {
-    QString root = "";
-    for(uint i=0; i<length; i++)
-    {   root += *(charset.begin());
+    // une cible nulle n'est jamais atteinte : on parcourt l'espace jusqu'à expiration du délai
+    if(!decideHashAlgorithm(hashFunction)) return false;
+    if(!decodeTarget(QString(2 * QCryptographicHash::hash(QByteArray(), _hash_algorithm).size(), '0'))) return false;
+    if(!_keyspace.Build(BENCH_CHARSET, BENCH_LENGTH, BENCH_LENGTH))
+    {   _error = _keyspace.error();
+        return false;
     }
-    return bruteForceRecursif(charset, root, 1, length, target);
+    _start_index = 0;
+    _end_index = _keyspace.size();
+
+    QElapsedTimer timer;
+    timer.start();
+    bruteForce(decideThreads(threads), durationMs);
+    qint64 elapsed = timer.elapsed();
+    rate = elapsed > 0 ? (_tested.load() * 1000.0) / elapsed : 0.0;
+    return true;
+}
+
+
+int Computer::decideThreads(int requested) const
+{
+    // un thread par coeur sauf si le nombre de threads est imposé, dans la limite de quelques
+    // threads par coeur : une valeur aberrante ne crée pas des milliers de threads
+    int cores = qMax(1, QThread::idealThreadCount());
+    int threads = requested;
+    if(threads <= 0) threads = cores;
+    return qMin(threads, THREADS_PER_CORE_MAX * cores);
 }
 
 
-bool Computer::bruteForceRecursif(std::set<QChar> charset, QString prefixe, uint longueur, uint longueur_max, QString target)
+bool Computer::bruteForce(int threads, int timeoutMs)
 {
-    if(longueur == longueur_max)
-    {
-        for(std::set<QChar>::iterator charIter = charset.begin(); charIter != charset.end(); ++charIter)
-        {
-            // on génére et on teste une nouvelle proposition
-            prefixe.replace(longueur_max - 1, 1, *charIter);
-            QString hashed = QCryptographicHash::hash(prefixe.toUtf8(), _hash_algorithm).toHex();
+    KeyspaceScheduler scheduler(_start_index, _end_index, threads, SEARCH_CHUNK);
+    _scheduler = &scheduler;
+    _stop.store(0);
+    _tested.store(0);
+
+    // chaque thread consomme sa part de l'espace de clés puis vole le travail des autres
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for(int w = 0; w < threads; w++)
+    {   pool.start(new SearchTask(this, w));
+    }
+    if(timeoutMs < 0)
+    {   // sans délai, l'avancement est écrit périodiquement pour le client
+        while(!pool.waitForDone(PROGRESS_PERIOD)) reportProgress();
+    }
+    else if(!pool.waitForDone(timeoutMs))
+    {   // délai écoulé : les threads s'arrêtent à la fin de leur morceau courant
+        _stop.store(1);
+        pool.waitForDone();
+    }
+
+    _scheduler = NULL;
+    return _match_found;
+}
+
 
-            // si la cible a été trouvée, on met à jour le résultat et on arrête l'exploration récursive
-            if(QString::compare(target, hashed, Qt::CaseInsensitive) == 0)
-            {   _match_string = prefixe;
-                return true;
+void Computer::search(int worker)
+{
+    QCryptographicHash hash(_hash_algorithm);
+    quint64 begin, end;
+    while(!_stop.load() && _scheduler->Take(worker, begin, end))
+    {   if(_wordlist_mode)
+        {   searchWords(begin, end, hash);
+        }
+        else if(_batch_hash)
+        {   searchRangeBatch(begin, end);
+        }
+        else
+        {   searchRange(begin, end, hash);
+        }
+        _tested.fetchAndAddRelaxed(end - begin);
+    }
+}
+
+
+void Computer::reportProgress()
+{
+    // 100 est réservé au résultat : l'avancement annoncé reste inférieur tant que la recherche dure
+    quint64 total = _end_index - _start_index;
+    int percent = total > 0 ? (int)qMin(99.0, 100.0 * _tested.load() / total) : 0;
+    std::cout << CS_PROGRESS << " " << percent << std::endl;
+
+    // point de reprise : paramètres à substituer à ceux du fragment s'il est réattribué
+    quint64 mark = qMin(_scheduler->Checkpoint(), _end_index);
+    // en mode dictionnaire, on reprend au début de ligne suivant
+    if(_wordlist_mode) mark = _wordlist.AlignToLine(mark);
+    if(mark > _start_index)
+    {   QJsonObject checkpoint;
+        checkpoint.insert(PARAM_START_INDEX, QString::number(mark));
+        QMutexLocker locker(&_match_mutex);
+        if(_match_found)
+        {   QJsonArray matches;
+            for(QMap<QByteArray, QString>::const_iterator it = _matches.constBegin(); it != _matches.constEnd(); ++it)
+            {   QJsonObject match;
+                match.insert(PARAM_TARGET, QString(it.key().toHex()));
+                match.insert(PARAM_MATCH_STR, it.value());
+                matches.append(match);
             }
+            checkpoint.insert(PARAM_MATCH_STR, _match_string);
+            checkpoint.insert(PARAM_MATCHES, matches);
         }
-        return false;
+        std::cout << CS_CHECKPOINT << " " << QJsonDocument(checkpoint).toJson(QJsonDocument::Compact).constData() << std::endl;
     }
-    else
-    {
-        for(std::set<QChar>::iterator charIter = charset.begin(); charIter != charset.end(); ++charIter)
-        {   prefixe.replace(longueur - 1, 1, *charIter);
-            if(bruteForceRecursif(charset, prefixe, longueur + 1, longueur_max, target)) return true;
+}
+
+
+void Computer::restoreMatches(const QVariantMap &params)
+{
+    foreach(const QVariant & value, params.value(PARAM_MATCHES).toList())
+    {   QVariantMap match = value.toMap();
+        QByteArray digest = QByteArray::fromHex(match.value(PARAM_TARGET).toString().toLatin1());
+        // une correspondance inconnue ou mal formée est ignorée, elle sera cherchée à nouveau
+        if(digest.size() != _digest_length || !_targets.contains(digest.constData())) continue;
+        _matches.insert(digest, match.value(PARAM_MATCH_STR).toString());
+    }
+    if(!_matches.isEmpty())
+    {   // les correspondances restaurées précèdent tout l'intervalle restant
+        _match_found = true;
+        _match_string = params.value(PARAM_MATCH_STR, _matches.first()).toString();
+        _match_index = 0;
+    }
+}
+
+
+void Computer::searchRange(quint64 begin, quint64 end, QCryptographicHash &hash)
+{
+    unsigned char buffer[DIGEST_MAX_LEN];
+    // recherche de la longueur du premier candidat du morceau
+    int l = _keyspace.LengthIndexOf(begin);
+
+    // un morceau peut chevaucher plusieurs longueurs de candidats
+    while(begin < end)
+    {   quint64 stop = qMin(end, _keyspace.offset(l + 1));
+        CandidateGenerator generator(_keyspace.positions(l));
+        generator.seek(begin - _keyspace.offset(l));
+        for(quint64 i = begin; i < stop; i++)
+        {   // on teste la proposition courante, le générateur la modifie en place
+            const char * digest = hashOne(hash, generator.data(), generator.length(), buffer);
+
+            // si une cible a été trouvée on met à jour le résultat, on s'arrête quand toutes l'ont été
+            if(_targets.contains(digest) && foundMatch(generator.data(), generator.length(), digest, i))
+            {   return;
+            }
+            generator.next();
         }
-        return false;
+        begin = stop;
+        l++;
     }
 }
 
 
-// A modifier au besoin, en fonction du format retenu pour le charset
-bool Computer::possibleCharacters(std::set<QChar> *possible_characters, QString charset)
+void Computer::searchRangeBatch(quint64 begin, quint64 end)
 {
-    if(charset.size() == 0)
-    { _error = QString("Incorrect parameter : '%1' !").arg(PARAM_CHARSET);
+    // une voie par candidat : les candidats sont copiés dans des tampons fixes puis hachés par lots
+    char candidates[HASH_KERNEL_MAX_LANES][HASH_KERNEL_MAX_MSG_LEN];
+    const unsigned char * msgs[HASH_KERNEL_MAX_LANES];
+    int lens[HASH_KERNEL_MAX_LANES];
+    quint64 indexes[HASH_KERNEL_MAX_LANES];
+    unsigned char digests[HASH_KERNEL_MAX_LANES * HASH_KERNEL_MAX_DIGEST_LEN];
+    for(int lane = 0; lane < HASH_KERNEL_MAX_LANES; lane++)
+    {   msgs[lane] = (const unsigned char *)candidates[lane];
+        lens[lane] = 0;
+    }
+    int filled = 0;
+
+    int l = _keyspace.LengthIndexOf(begin);
+
+    while(begin < end)
+    {   quint64 stop = qMin(end, _keyspace.offset(l + 1));
+        CandidateGenerator generator(_keyspace.positions(l));
+        generator.seek(begin - _keyspace.offset(l));
+        for(quint64 i = begin; i < stop; i++)
+        {   memcpy(candidates[filled], generator.data(), generator.length());
+            lens[filled] = generator.length();
+            indexes[filled] = i;
+            if(++filled == _batch_lanes)
+            {   if(matchBatch(filled, msgs, lens, indexes, digests)) return;
+                filled = 0;
+            }
+            generator.next();
+        }
+        begin = stop;
+        l++;
+    }
+
+    // dernier lot incomplet : les voies restantes hachent d'anciens candidats ignorés
+    if(filled > 0)
+    {   matchBatch(filled, msgs, lens, indexes, digests);
+    }
+}
+
+
+void Computer::searchWords(quint64 begin, quint64 end, QCryptographicHash &hash)
+{
+    // les mots sont hachés directement dans la projection du fichier, sans copie
+    const char * base = _wordlist.at();
+    const unsigned char * msgs[HASH_KERNEL_MAX_LANES];
+    int lens[HASH_KERNEL_MAX_LANES];
+    quint64 indexes[HASH_KERNEL_MAX_LANES];
+    unsigned char digests[HASH_KERNEL_MAX_LANES * HASH_KERNEL_MAX_DIGEST_LEN];
+    unsigned char buffer[DIGEST_MAX_LEN];
+    for(int lane = 0; lane < HASH_KERNEL_MAX_LANES; lane++)
+    {   msgs[lane] = (const unsigned char *)base + begin;
+        lens[lane] = 0;
+    }
+    int filled = 0;
+
+    // un morceau qui commence en milieu de ligne laisse ce mot au morceau précédent
+    quint64 p = begin;
+    if(p > _start_index)
+    {   while(p < end && base[p - 1] != '\n') p++;
+    }
+
+    while(p < end)
+    {   const char * word = base + p;
+        const char * eol = (const char *)memchr(word, '\n', _words_end - p);
+        int length = eol ? (int)(eol - word) : (int)(_words_end - p);
+        quint64 next = p + length + 1;
+        if(length > 0 && word[length - 1] == '\r') length--;
+
+        if(length == 0)
+        {   // ligne vide ignorée
+        }
+        else if(_batch_hash && length <= HASH_KERNEL_MAX_MSG_LEN)
+        {   msgs[filled] = (const unsigned char *)word;
+            lens[filled] = length;
+            indexes[filled] = p;
+            if(++filled == _batch_lanes)
+            {   if(matchBatch(filled, msgs, lens, indexes, digests)) return;
+                filled = 0;
+            }
+        }
+        else
+        {   // mot trop long pour les noyaux ou algo sans noyau
+            const char * digest = hashOne(hash, word, length, buffer);
+            if(_targets.contains(digest) && foundMatch(word, length, digest, p))
+            {   return;
+            }
+        }
+        p = next;
+    }
+
+    if(filled > 0)
+    {   matchBatch(filled, msgs, lens, indexes, digests);
+    }
+}
+
+
+const char * Computer::hashOne(QCryptographicHash &hash, const char *data, int length, unsigned char *digest) const
+{
+    // md5, sha1 et sha256 : l'empreinte est écrite dans le tampon de l'appelant
+    if(_message_hash)
+    {   _message_hash((const unsigned char *)data, length, digest);
+        return (const char *)digest;
+    }
+    hash.reset();
+    hash.addData(data, length);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    // l'empreinte est lue dans l'objet de hachage, valable jusqu'au prochain reset()
+    Q_UNUSED(digest);
+    return hash.resultView().data();
+#else
+    // avant Qt 6.3 l'empreinte n'est rendue que dans un nouveau QByteArray
+    QByteArray result = hash.result();
+    memcpy(digest, result.constData(), result.size());
+    return (const char *)digest;
+#endif
+}
+
+
+bool Computer::matchBatch(int count, const unsigned char * const * msgs, const int * lens, const quint64 * indexes, unsigned char * digests)
+{
+    _batch_hash(msgs, lens, digests);
+    for(int lane = 0; lane < count; lane++)
+    {   const char * digest = (const char *)digests + lane * _digest_length;
+        if(_targets.contains(digest) && foundMatch((const char *)msgs[lane], lens[lane], digest, indexes[lane]))
+        {   return true;
+        }
+    }
+    return false;
+}
+
+
+bool Computer::foundMatch(const char *candidate, int length, const char *digest, quint64 index)
+{
+    QMutexLocker locker(&_match_mutex);
+    QString match = QString::fromUtf8(candidate, length);
+    // match_str reste la correspondance de plus petit rang, quel que soit l'ordre des threads
+    if(!_match_found || index < _match_index)
+    {   _match_found = true;
+        _match_string = match;
+        _match_index = index;
+    }
+    _matches.insert(QByteArray(digest, _digest_length), match);
+    // toutes les cibles ont été trouvées : inutile de continuer, on arrête tous les threads
+    if(_matches.size() == _targets.count())
+    {   _stop.store(1);
+        return true;
+    }
+    return false;
+}
+
+
+bool Computer::decideCandidates(const QVariantMap &params)
+{
+    if(params.contains(PARAM_WORDLIST))
+    {   _wordlist_mode = true;
+        if(!_wordlist.Open(params.value(PARAM_WORDLIST).toString()))
+        {   _error = _wordlist.error();
+            return false;
+        }
+        if(!decideRange(params, _wordlist.size())) return false;
+        // le dernier mot commençant dans l'intervalle peut déborder si la fin n'est pas alignée
+        _words_end = _wordlist.AlignToLine(_end_index);
+        if(!_wordlist.Map(_start_index, _words_end))
+        {   _error = _wordlist.error();
+            return false;
+        }
+        return true;
+    }
+
+    // génération des jeux de charactères (charset ou masque) et linéarisation de l'espace de clés
+    if(!_keyspace.Build(params))
+    {   _error = _keyspace.error();
         return false;
     }
+    // les noyaux multi-voies ne traitent que des candidats tenant sur un seul bloc
+    if(_keyspace.maxLength() > HASH_KERNEL_MAX_MSG_LEN) _batch_hash = NULL;
+    // intervalle de l'espace de clés attribué à ce fragment, tout l'espace par défaut
+    return decideRange(params, _keyspace.size());
+}
+
 
-    for(int i = 0; i < charset.length(); i++)
-    {   possible_characters->insert(charset.at(i));
+bool Computer::decideRange(const QVariantMap & params, quint64 size)
+{
+    bool ok = true;
+    _start_index = params.contains(PARAM_START_INDEX) ? params.value(PARAM_START_INDEX).toULongLong(&ok) : 0;
+    if(ok)
+    {   _end_index = params.contains(PARAM_END_INDEX) ? params.value(PARAM_END_INDEX).toULongLong(&ok) : size;
+    }
+    if(!ok || _start_index > _end_index || _end_index > size)
+    {   _error = QString("Incorrect parameters : '%1' and '%2' must verify 0 <= %1 <= %2 <= %3 !")
+                .arg(PARAM_START_INDEX, PARAM_END_INDEX).arg(size);
+        return false;
     }
+    return true;
+}
 
+
+bool Computer::decodeTarget(const QVariant &target)
+{
+    // toutes les empreintes supportées font au moins 16 octets (md4/md5)
+    _digest_length = QCryptographicHash::hash(QByteArray(), _hash_algorithm).size();
+    if(!_targets.Build(target, _digest_length))
+    {   _error = _targets.error();
+        return false;
+    }
     return true;
 }
 
 
 bool Computer::decideHashAlgorithm(QString requested_algorithm)
 {
+    // md5, sha1 et sha256 disposent de noyaux multi-voies choisis selon le processeur
+    const HashKernel & kernel = SelectHashKernel();
+    _batch_hash = NULL;
+    _batch_lanes = kernel.lanes;
+    _message_hash = NULL;
+
     if (QString::compare(requested_algorithm, "Md4", Qt::CaseInsensitive) == 0)
     {   _hash_algorithm = QCryptographicHash::Md4;
         return true;
     }
     else if (QString::compare(requested_algorithm, "Md5", Qt::CaseInsensitive) == 0)
     {   _hash_algorithm = QCryptographicHash::Md5;
+        _batch_hash = kernel.md5;
+        _message_hash = HashMessageMd5;
         return true;
     }
     else if (QString::compare(requested_algorithm, "Sha1", Qt::CaseInsensitive) == 0)
     {   _hash_algorithm = QCryptographicHash::Sha1;
+        _batch_hash = kernel.sha1;
+        _message_hash = HashMessageSha1;
         return true;
     }
     else if (QString::compare(requested_algorithm, "Sha224", Qt::CaseInsensitive) == 0)
@@ -148,6 +529,8 @@ bool Computer::decideHashAlgorithm(QString requested_algorithm)
     }
     else if (QString::compare(requested_algorithm, "Sha256", Qt::CaseInsensitive) == 0)
     {   _hash_algorithm = QCryptographicHash::Sha256;
+        _batch_hash = kernel.sha256;
+        _message_hash = HashMessageSha256;
         return true;
     }
     else if (QString::compare(requested_algorithm, "Sha384", Qt::CaseInsensitive) == 0)
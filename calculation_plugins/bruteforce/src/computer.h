@@ -2,8 +2,20 @@
 #define COMPUTER_H
 
 #include <QString>
-#include <set>
+#include <QByteArray>
+#include <QVariantMap>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
 #include <QCryptographicHash>
+#include <QMap>
+
+#include "hashkernels.h"
+#include "keyspace.h"
+#include "targetset.h"
+#include "wordlist.h"
+
+class KeyspaceScheduler;
 
 class Computer
 {
@@ -11,20 +23,72 @@ public:
     Computer();
 
     bool compute(const QString & json);
+    /**
+     * @brief Mesure le débit de recherche réel (noyaux, threads) pour un algorithme de hachage
+     * @param hashFunction
+     *      Nom de l'algorithme, comme pour le paramètre hash_func
+     * @param threads
+     *      Nombre de threads de recherche, 0 pour un thread par coeur
+     * @param durationMs
+     *      Durée approximative de la mesure
+     * @param rate
+     *      Reçoit le débit mesuré en candidats par seconde
+     */
+    bool measure(const QString & hashFunction, int threads, int durationMs, double & rate);
     inline QString error() const { return _error; }
     inline QString result() const { return _result; }
 
 private:
+    friend class SearchTask;
+
     QString _error;
     QString _result;
 
     QString _match_string;
+    bool _match_found;
+    quint64 _match_index;
     QCryptographicHash::Algorithm _hash_algorithm;
+    // noyau multi-voies de l'algorithme choisi, NULL s'il n'y en a pas (repli sur QCryptographicHash)
+    HashBatchFunction _batch_hash;
+    int _batch_lanes;
+    // version scalaire du noyau pour un candidat de longueur quelconque, NULL s'il n'y en a pas
+    HashMessageFunction _message_hash;
+    // empreintes cibles décodées une seule fois et correspondances trouvées (empreinte -> candidat)
+    TargetSet _targets;
+    QMap<QByteArray, QString> _matches;
+    int _digest_length;
+
+    // espace de clés linéarisé ou fichier de mots, et intervalle [_start_index, _end_index) à énumérer
+    // (rangs de candidats ou octets du fichier, les mots commençant dans l'intervalle sont testés)
+    Keyspace _keyspace;
+    Wordlist _wordlist;
+    bool _wordlist_mode;
+    quint64 _words_end;
+    quint64 _start_index;
+    quint64 _end_index;
+
+    // état partagé entre les threads de recherche
+    KeyspaceScheduler * _scheduler;
+    QAtomicInt _stop;
+    QMutex _match_mutex;
+    // indices traités, lu pendant la recherche pour l'avancement
+    QAtomicInteger<quint64> _tested;
 
-    bool bruteForceRecursif(std::set<QChar> charset, QString prefixe, uint longueur, uint longueur_max, QString target);
-    bool bruteForce(std::set<QChar> charset, uint length, QString target);
+    bool bruteForce(int threads, int timeoutMs = -1);
+    int decideThreads(int requested) const;
+    void reportProgress();
+    void restoreMatches(const QVariantMap & params);
+    void search(int worker);
+    void searchRange(quint64 begin, quint64 end, QCryptographicHash & hash);
+    void searchRangeBatch(quint64 begin, quint64 end);
+    void searchWords(quint64 begin, quint64 end, QCryptographicHash & hash);
+    const char * hashOne(QCryptographicHash & hash, const char * data, int length, unsigned char * digest) const;
+    bool matchBatch(int count, const unsigned char * const * msgs, const int * lens, const quint64 * indexes, unsigned char * digests);
+    bool foundMatch(const char * candidate, int length, const char * digest, quint64 index);
+    bool decodeTarget(const QVariant & target);
+    bool decideRange(const QVariantMap & params, quint64 size);
+    bool decideCandidates(const QVariantMap & params);
     bool decideHashAlgorithm(QString requested_algorithm);
-    bool possibleCharacters(std::set<QChar> *possible_characters, QString charset);
 };
 
 #endif // COMPUTER_H
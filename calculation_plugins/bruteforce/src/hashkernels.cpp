@@ -0,0 +1,41 @@
+#include "hashkernels.h"
+
+extern const HashKernel HashKernelScalar;
+#ifdef HASH_KERNELS_X86
+extern const HashKernel HashKernelSse41;
+extern const HashKernel HashKernelAvx2;
+extern const HashKernel HashKernelAvx512;
+#endif
+
+const HashKernel * const * SupportedHashKernels(int * count)
+{
+    static const HashKernel * kernels[4];
+    static int n = 0;
+    if(n == 0)
+    {   // -- le premier appel a lieu avant le démarrage des threads de recherche
+        int found = 0;
+        kernels[found++] = &HashKernelScalar;
+#ifdef HASH_KERNELS_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("sse4.1"))
+        {   kernels[found++] = &HashKernelSse41;
+        }
+        if(__builtin_cpu_supports("avx2"))
+        {   kernels[found++] = &HashKernelAvx2;
+        }
+        if(__builtin_cpu_supports("avx512f"))
+        {   kernels[found++] = &HashKernelAvx512;
+        }
+#endif
+        n = found;
+    }
+    *count = n;
+    return kernels;
+}
+
+const HashKernel & SelectHashKernel()
+{
+    int count;
+    const HashKernel * const * kernels = SupportedHashKernels(&count);
+    return *kernels[count - 1];
+}
@@ -0,0 +1,69 @@
+#ifndef HASHKERNELS_H
+#define HASHKERNELS_H
+
+#include <stdint.h>
+
+// -- les noyaux vectoriels ne sont compilés que pour x86 avec gcc ou clang
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   define HASH_KERNELS_X86
+#endif
+
+#define HASH_KERNEL_MAX_LANES       16
+#define HASH_KERNEL_MAX_MSG_LEN     55  // un message doit tenir dans un seul bloc de 64 octets avec le padding
+#define HASH_KERNEL_MAX_DIGEST_LEN  32
+
+#define MD5_DIGEST_LEN      16
+#define SHA1_DIGEST_LEN     20
+#define SHA256_DIGEST_LEN   32
+
+/**
+ * @brief Hache un lot de messages en un seul appel, un message par voie
+ * @param msgs
+ *      Tableau de HashKernel::lanes pointeurs vers les messages
+ * @param lens
+ *      Tableau de HashKernel::lanes longueurs, chacune inférieure ou égale à HASH_KERNEL_MAX_MSG_LEN
+ * @param digests
+ *      Tampon de HashKernel::lanes empreintes brutes mises bout à bout
+ */
+typedef void (*HashBatchFunction)(const unsigned char * const * msgs, const int * lens, unsigned char * digests);
+
+/**
+ * @brief Hache un message de longueur quelconque sur une seule voie, sans allocation
+ * @param msg
+ *      Message à hacher
+ * @param len
+ *      Longueur du message en octets
+ * @param digest
+ *      Tampon recevant l'empreinte brute
+ */
+typedef void (*HashMessageFunction)(const unsigned char * msg, int len, unsigned char * digest);
+
+/**
+ * @brief Cette structure décrit un jeu de noyaux de hachage multi-voies pour un jeu d'instructions
+ */
+struct HashKernel {
+    const char * name;          ///< Nom du jeu d'instructions ciblé
+    int lanes;                  ///< Nombre de messages hachés par appel
+    HashBatchFunction md5;
+    HashBatchFunction sha1;
+    HashBatchFunction sha256;
+};
+
+// -- versions scalaires pour les messages trop longs pour les noyaux multi-voies
+void HashMessageMd5(const unsigned char * msg, int len, unsigned char * digest);
+void HashMessageSha1(const unsigned char * msg, int len, unsigned char * digest);
+void HashMessageSha256(const unsigned char * msg, int len, unsigned char * digest);
+
+/**
+ * @brief Retourne le noyau le plus large supporté par le processeur courant (détection à l'exécution)
+ */
+const HashKernel & SelectHashKernel();
+
+/**
+ * @brief Retourne tous les noyaux supportés par le processeur courant, du plus simple au plus large
+ * @param count
+ *      Reçoit le nombre de noyaux retournés
+ */
+const HashKernel * const * SupportedHashKernels(int * count);
+
+#endif // HASHKERNELS_H
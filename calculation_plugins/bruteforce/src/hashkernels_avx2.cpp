@@ -0,0 +1,41 @@
+#include "hashkernels.h"
+
+#ifdef HASH_KERNELS_X86
+
+#include <immintrin.h>
+
+// -- 8 voies sur des registres de 256 bits, le jeu d'instructions est activé pour ce seul fichier
+#ifdef __clang__
+#   pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#else
+#   pragma GCC push_options
+#   pragma GCC target("avx2")
+#endif
+
+typedef __m256i vec_t;
+#define LANES           8
+#define KERNEL(name)    name##_avx2
+
+static inline vec_t v_set1(uint32_t x)                  { return _mm256_set1_epi32((int)x); }
+static inline vec_t v_load(const uint32_t * p)          { return _mm256_loadu_si256((const __m256i *)p); }
+static inline void  v_store(uint32_t * p, vec_t v)      { _mm256_storeu_si256((__m256i *)p, v); }
+static inline vec_t v_add(vec_t a, vec_t b)             { return _mm256_add_epi32(a, b); }
+static inline vec_t v_xor(vec_t a, vec_t b)             { return _mm256_xor_si256(a, b); }
+static inline vec_t v_and(vec_t a, vec_t b)             { return _mm256_and_si256(a, b); }
+static inline vec_t v_or(vec_t a, vec_t b)              { return _mm256_or_si256(a, b); }
+static inline vec_t v_andnot(vec_t a, vec_t b)          { return _mm256_andnot_si256(a, b); }
+static inline vec_t v_shl(vec_t x, int n)               { return _mm256_sll_epi32(x, _mm_cvtsi32_si128(n)); }
+static inline vec_t v_shr(vec_t x, int n)               { return _mm256_srl_epi32(x, _mm_cvtsi32_si128(n)); }
+static inline vec_t v_rotl(vec_t x, int n)              { return v_or(v_shl(x, n), v_shr(x, 32 - n)); }
+
+#include "hashkernels_impl.h"
+
+#ifdef __clang__
+#   pragma clang attribute pop
+#else
+#   pragma GCC pop_options
+#endif
+
+extern const HashKernel HashKernelAvx2 = { "avx2", LANES, md5_avx2, sha1_avx2, sha256_avx2 };
+
+#endif // HASH_KERNELS_X86
@@ -0,0 +1,46 @@
+#include "hashkernels.h"
+
+#ifdef HASH_KERNELS_X86
+
+#include <immintrin.h>
+
+// -- 16 voies sur des registres de 512 bits, le jeu d'instructions est activé pour ce seul fichier
+#ifdef __clang__
+#   pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#   pragma GCC push_options
+#   pragma GCC target("avx512f")
+    // faux positif de gcc sur _mm512_undefined_epi32() dans les en-têtes d'intrinsèques
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+typedef __m512i vec_t;
+#define LANES           16
+#define KERNEL(name)    name##_avx512
+
+static inline vec_t v_set1(uint32_t x)                  { return _mm512_set1_epi32((int)x); }
+static inline vec_t v_load(const uint32_t * p)          { return _mm512_loadu_si512((const void *)p); }
+static inline void  v_store(uint32_t * p, vec_t v)      { _mm512_storeu_si512((void *)p, v); }
+static inline vec_t v_add(vec_t a, vec_t b)             { return _mm512_add_epi32(a, b); }
+static inline vec_t v_xor(vec_t a, vec_t b)             { return _mm512_xor_si512(a, b); }
+static inline vec_t v_and(vec_t a, vec_t b)             { return _mm512_and_si512(a, b); }
+static inline vec_t v_or(vec_t a, vec_t b)              { return _mm512_or_si512(a, b); }
+static inline vec_t v_andnot(vec_t a, vec_t b)          { return _mm512_andnot_si512(a, b); }
+static inline vec_t v_shl(vec_t x, int n)               { return _mm512_sll_epi32(x, _mm_cvtsi32_si128(n)); }
+static inline vec_t v_shr(vec_t x, int n)               { return _mm512_srl_epi32(x, _mm_cvtsi32_si128(n)); }
+// rotation native (vprolvd) disponible avec AVX-512
+static inline vec_t v_rotl(vec_t x, int n)              { return _mm512_rolv_epi32(x, _mm512_set1_epi32(n)); }
+
+#include "hashkernels_impl.h"
+
+#ifdef __clang__
+#   pragma clang attribute pop
+#else
+#   pragma GCC diagnostic pop
+#   pragma GCC pop_options
+#endif
+
+extern const HashKernel HashKernelAvx512 = { "avx512", LANES, md5_avx512, sha1_avx512, sha256_avx512 };
+
+#endif // HASH_KERNELS_X86
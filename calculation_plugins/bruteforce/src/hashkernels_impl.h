@@ -0,0 +1,278 @@
+/*
+ *  Corps commun des noyaux de hachage multi-voies.
+ *
+ *  Ce fichier n'a pas de garde d'inclusion : il est inclus une fois par jeu d'instructions
+ *  (hashkernels_<isa>.cpp) après la définition de :
+ *      - vec_t             : vecteur de LANES mots de 32 bits
+ *      - LANES             : nombre de voies
+ *      - KERNEL(name)      : suffixe des fonctions générées
+ *      - v_set1, v_load, v_store, v_add, v_xor, v_and, v_or, v_andnot, v_shl, v_shr, v_rotl
+ *
+ *  Les messages sont d'abord complétés et transposés (un mot par voie, voies contiguës) puis
+ *  la fonction de compression est déroulée sur les vecteurs. Chaque message tient sur un bloc.
+ *  Les fonctions de compression (<algo>_block) servent aussi au hachage d'un message de
+ *  longueur quelconque, bloc par bloc, dans la version scalaire.
+ */
+
+#include <string.h>
+
+// -- préparation d'un bloc de 64 octets par voie, transposé mot par mot
+
+static inline void KERNEL(pack)(const unsigned char * const * msgs, const int * lens, uint32_t w[16][LANES], bool bigEndian)
+{
+    for(int lane = 0; lane < LANES; lane++)
+    {   unsigned char block[64];
+        int len = lens[lane];
+        memcpy(block, msgs[lane], len);
+        block[len] = 0x80;
+        memset(block + len + 1, 0, 64 - len - 1);
+        uint64_t bits = (uint64_t)len * 8;
+        for(int i = 0; i < 8; i++)
+        {   block[bigEndian ? 63 - i : 56 + i] = (unsigned char)(bits >> (8 * i));
+        }
+        for(int i = 0; i < 16; i++)
+        {   const unsigned char * p = block + 4 * i;
+            w[i][lane] = bigEndian ?
+                        ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3] :
+                        ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+        }
+    }
+}
+
+// -- état initial, le même pour toutes les voies
+
+static inline void KERNEL(init)(vec_t * state, const uint32_t * iv, int words)
+{
+    for(int i = 0; i < words; i++)
+    {   state[i] = v_set1(iv[i]);
+    }
+}
+
+// -- écriture des empreintes voie par voie
+
+static inline void KERNEL(unpack)(const vec_t * state, int words, bool bigEndian, unsigned char * digests)
+{
+    uint32_t out[8][LANES];
+    for(int i = 0; i < words; i++)
+    {   v_store(out[i], state[i]);
+    }
+    for(int lane = 0; lane < LANES; lane++)
+    {   unsigned char * d = digests + lane * words * 4;
+        for(int i = 0; i < words; i++)
+        {   uint32_t x = out[i][lane];
+            for(int b = 0; b < 4; b++)
+            {   d[4 * i + b] = (unsigned char)(bigEndian ? x >> (24 - 8 * b) : x >> (8 * b));
+            }
+        }
+    }
+}
+
+// -- MD5
+
+static const uint32_t KERNEL(md5_k)[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+static inline vec_t KERNEL(md5_f)(vec_t b, vec_t c, vec_t d) { return v_xor(d, v_and(b, v_xor(c, d))); }
+static inline vec_t KERNEL(md5_g)(vec_t b, vec_t c, vec_t d) { return v_xor(c, v_and(d, v_xor(b, c))); }
+static inline vec_t KERNEL(md5_h)(vec_t b, vec_t c, vec_t d) { return v_xor(b, v_xor(c, d)); }
+static inline vec_t KERNEL(md5_i)(vec_t b, vec_t c, vec_t d) { return v_xor(c, v_or(b, v_andnot(d, v_set1(0xffffffff)))); }
+
+#define MD5_STEP(f, a, b, c, d, x, t, s) \
+    a = v_add(b, v_rotl(v_add(v_add(a, f(b, c, d)), v_add(x, v_set1(KERNEL(md5_k)[t]))), s))
+
+static const uint32_t KERNEL(md5_iv)[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+static inline void KERNEL(md5_block)(vec_t * state, const vec_t * m)
+{
+    vec_t a = state[0], b = state[1], c = state[2], d = state[3];
+
+    for(int i = 0; i < 16; i += 4)
+    {   MD5_STEP(KERNEL(md5_f), a, b, c, d, m[i],     i,     7);
+        MD5_STEP(KERNEL(md5_f), d, a, b, c, m[i + 1], i + 1, 12);
+        MD5_STEP(KERNEL(md5_f), c, d, a, b, m[i + 2], i + 2, 17);
+        MD5_STEP(KERNEL(md5_f), b, c, d, a, m[i + 3], i + 3, 22);
+    }
+    for(int i = 16; i < 32; i += 4)
+    {   MD5_STEP(KERNEL(md5_g), a, b, c, d, m[(5 * i + 1) & 15],  i,     5);
+        MD5_STEP(KERNEL(md5_g), d, a, b, c, m[(5 * i + 6) & 15],  i + 1, 9);
+        MD5_STEP(KERNEL(md5_g), c, d, a, b, m[(5 * i + 11) & 15], i + 2, 14);
+        MD5_STEP(KERNEL(md5_g), b, c, d, a, m[(5 * i + 16) & 15], i + 3, 20);
+    }
+    for(int i = 32; i < 48; i += 4)
+    {   MD5_STEP(KERNEL(md5_h), a, b, c, d, m[(3 * i + 5) & 15],  i,     4);
+        MD5_STEP(KERNEL(md5_h), d, a, b, c, m[(3 * i + 8) & 15],  i + 1, 11);
+        MD5_STEP(KERNEL(md5_h), c, d, a, b, m[(3 * i + 11) & 15], i + 2, 16);
+        MD5_STEP(KERNEL(md5_h), b, c, d, a, m[(3 * i + 14) & 15], i + 3, 23);
+    }
+    for(int i = 48; i < 64; i += 4)
+    {   MD5_STEP(KERNEL(md5_i), a, b, c, d, m[(7 * i) & 15],      i,     6);
+        MD5_STEP(KERNEL(md5_i), d, a, b, c, m[(7 * i + 7) & 15],  i + 1, 10);
+        MD5_STEP(KERNEL(md5_i), c, d, a, b, m[(7 * i + 14) & 15], i + 2, 15);
+        MD5_STEP(KERNEL(md5_i), b, c, d, a, m[(7 * i + 21) & 15], i + 3, 21);
+    }
+
+    state[0] = v_add(state[0], a);
+    state[1] = v_add(state[1], b);
+    state[2] = v_add(state[2], c);
+    state[3] = v_add(state[3], d);
+}
+
+#undef MD5_STEP
+
+static void KERNEL(md5)(const unsigned char * const * msgs, const int * lens, unsigned char * digests)
+{
+    uint32_t w[16][LANES];
+    KERNEL(pack)(msgs, lens, w, false);
+    vec_t m[16];
+    for(int i = 0; i < 16; i++)
+    {   m[i] = v_load(w[i]);
+    }
+    vec_t state[4];
+    KERNEL(init)(state, KERNEL(md5_iv), 4);
+    KERNEL(md5_block)(state, m);
+    KERNEL(unpack)(state, 4, false, digests);
+}
+
+// -- SHA-1
+
+static const uint32_t KERNEL(sha1_iv)[5] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0 };
+
+static inline void KERNEL(sha1_block)(vec_t * state, const vec_t * block)
+{
+    vec_t m[80];
+    for(int t = 0; t < 16; t++)
+    {   m[t] = block[t];
+    }
+    for(int t = 16; t < 80; t++)
+    {   m[t] = v_rotl(v_xor(v_xor(m[t - 3], m[t - 8]), v_xor(m[t - 14], m[t - 16])), 1);
+    }
+
+    vec_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+    for(int t = 0; t < 80; t++)
+    {   vec_t f, k;
+        if(t < 20)
+        {   f = v_xor(d, v_and(b, v_xor(c, d)));
+            k = v_set1(0x5a827999);
+        }
+        else if(t < 40)
+        {   f = v_xor(b, v_xor(c, d));
+            k = v_set1(0x6ed9eba1);
+        }
+        else if(t < 60)
+        {   f = v_or(v_and(b, c), v_and(d, v_or(b, c)));
+            k = v_set1(0x8f1bbcdc);
+        }
+        else
+        {   f = v_xor(b, v_xor(c, d));
+            k = v_set1(0xca62c1d6);
+        }
+        vec_t temp = v_add(v_add(v_rotl(a, 5), f), v_add(v_add(e, k), m[t]));
+        e = d;
+        d = c;
+        c = v_rotl(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    state[0] = v_add(state[0], a);
+    state[1] = v_add(state[1], b);
+    state[2] = v_add(state[2], c);
+    state[3] = v_add(state[3], d);
+    state[4] = v_add(state[4], e);
+}
+
+static void KERNEL(sha1)(const unsigned char * const * msgs, const int * lens, unsigned char * digests)
+{
+    uint32_t w[16][LANES];
+    KERNEL(pack)(msgs, lens, w, true);
+    vec_t m[16];
+    for(int t = 0; t < 16; t++)
+    {   m[t] = v_load(w[t]);
+    }
+    vec_t state[5];
+    KERNEL(init)(state, KERNEL(sha1_iv), 5);
+    KERNEL(sha1_block)(state, m);
+    KERNEL(unpack)(state, 5, true, digests);
+}
+
+// -- SHA-256
+
+static const uint32_t KERNEL(sha256_k)[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline vec_t KERNEL(rotr)(vec_t x, int n) { return v_rotl(x, 32 - n); }
+
+static const uint32_t KERNEL(sha256_iv)[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                                0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+static inline void KERNEL(sha256_block)(vec_t * state, const vec_t * block)
+{
+    vec_t m[64];
+    for(int t = 0; t < 16; t++)
+    {   m[t] = block[t];
+    }
+    for(int t = 16; t < 64; t++)
+    {   vec_t s0 = v_xor(v_xor(KERNEL(rotr)(m[t - 15], 7), KERNEL(rotr)(m[t - 15], 18)), v_shr(m[t - 15], 3));
+        vec_t s1 = v_xor(v_xor(KERNEL(rotr)(m[t - 2], 17), KERNEL(rotr)(m[t - 2], 19)), v_shr(m[t - 2], 10));
+        m[t] = v_add(v_add(m[t - 16], s0), v_add(m[t - 7], s1));
+    }
+
+    vec_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], hh = state[7];
+
+    for(int t = 0; t < 64; t++)
+    {   vec_t S1 = v_xor(v_xor(KERNEL(rotr)(e, 6), KERNEL(rotr)(e, 11)), KERNEL(rotr)(e, 25));
+        vec_t ch = v_xor(g, v_and(e, v_xor(f, g)));
+        vec_t temp1 = v_add(v_add(hh, S1), v_add(v_add(ch, v_set1(KERNEL(sha256_k)[t])), m[t]));
+        vec_t S0 = v_xor(v_xor(KERNEL(rotr)(a, 2), KERNEL(rotr)(a, 13)), KERNEL(rotr)(a, 22));
+        vec_t maj = v_or(v_and(a, b), v_and(c, v_or(a, b)));
+        vec_t temp2 = v_add(S0, maj);
+        hh = g;
+        g = f;
+        f = e;
+        e = v_add(d, temp1);
+        d = c;
+        c = b;
+        b = a;
+        a = v_add(temp1, temp2);
+    }
+
+    state[0] = v_add(state[0], a);
+    state[1] = v_add(state[1], b);
+    state[2] = v_add(state[2], c);
+    state[3] = v_add(state[3], d);
+    state[4] = v_add(state[4], e);
+    state[5] = v_add(state[5], f);
+    state[6] = v_add(state[6], g);
+    state[7] = v_add(state[7], hh);
+}
+
+static void KERNEL(sha256)(const unsigned char * const * msgs, const int * lens, unsigned char * digests)
+{
+    uint32_t w[16][LANES];
+    KERNEL(pack)(msgs, lens, w, true);
+    vec_t m[16];
+    for(int t = 0; t < 16; t++)
+    {   m[t] = v_load(w[t]);
+    }
+    vec_t state[8];
+    KERNEL(init)(state, KERNEL(sha256_iv), 8);
+    KERNEL(sha256_block)(state, m);
+    KERNEL(unpack)(state, 8, true, digests);
+}
@@ -0,0 +1,82 @@
+#include "hashkernels.h"
+
+// -- version de repli portable : une seule voie, mots de 32 bits ordinaires
+
+typedef uint32_t vec_t;
+#define LANES           1
+#define KERNEL(name)    name##_scalar
+
+static inline vec_t v_set1(uint32_t x)                  { return x; }
+static inline vec_t v_load(const uint32_t * p)          { return *p; }
+static inline void  v_store(uint32_t * p, vec_t v)      { *p = v; }
+static inline vec_t v_add(vec_t a, vec_t b)             { return a + b; }
+static inline vec_t v_xor(vec_t a, vec_t b)             { return a ^ b; }
+static inline vec_t v_and(vec_t a, vec_t b)             { return a & b; }
+static inline vec_t v_or(vec_t a, vec_t b)              { return a | b; }
+static inline vec_t v_andnot(vec_t a, vec_t b)          { return ~a & b; }
+static inline vec_t v_shl(vec_t x, int n)               { return x << n; }
+static inline vec_t v_shr(vec_t x, int n)               { return x >> n; }
+static inline vec_t v_rotl(vec_t x, int n)              { return (x << n) | (x >> (32 - n)); }
+
+#include "hashkernels_impl.h"
+
+extern const HashKernel HashKernelScalar = { "scalar", LANES, md5_scalar, sha1_scalar, sha256_scalar };
+
+// -- messages de longueur quelconque, hachés bloc par bloc sur l'unique voie
+
+static inline void load_words(const unsigned char * p, vec_t * m, bool bigEndian)
+{
+    for(int i = 0; i < 16; i++, p += 4)
+    {   m[i] = bigEndian ?
+                    ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3] :
+                    ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+    }
+}
+
+static void hash_message(void (*block)(vec_t *, const vec_t *), vec_t * state, int words, bool bigEndian,
+                         const unsigned char * msg, int len, unsigned char * digest)
+{
+    vec_t m[16];
+    int done = 0;
+    for(; len - done >= 64; done += 64)
+    {   load_words(msg + done, m, bigEndian);
+        block(state, m);
+    }
+    // -- le reste, le padding et la longueur occupent un ou deux derniers blocs
+    unsigned char tail[128];
+    int rest = len - done;
+    int size = rest + 1 + 8 <= 64 ? 64 : 128;
+    memcpy(tail, msg + done, rest);
+    tail[rest] = 0x80;
+    memset(tail + rest + 1, 0, size - rest - 1);
+    uint64_t bits = (uint64_t)len * 8;
+    for(int i = 0; i < 8; i++)
+    {   tail[bigEndian ? size - 1 - i : size - 8 + i] = (unsigned char)(bits >> (8 * i));
+    }
+    for(int offset = 0; offset < size; offset += 64)
+    {   load_words(tail + offset, m, bigEndian);
+        block(state, m);
+    }
+    unpack_scalar(state, words, bigEndian, digest);
+}
+
+void HashMessageMd5(const unsigned char * msg, int len, unsigned char * digest)
+{
+    vec_t state[4];
+    init_scalar(state, md5_iv_scalar, 4);
+    hash_message(md5_block_scalar, state, 4, false, msg, len, digest);
+}
+
+void HashMessageSha1(const unsigned char * msg, int len, unsigned char * digest)
+{
+    vec_t state[5];
+    init_scalar(state, sha1_iv_scalar, 5);
+    hash_message(sha1_block_scalar, state, 5, true, msg, len, digest);
+}
+
+void HashMessageSha256(const unsigned char * msg, int len, unsigned char * digest)
+{
+    vec_t state[8];
+    init_scalar(state, sha256_iv_scalar, 8);
+    hash_message(sha256_block_scalar, state, 8, true, msg, len, digest);
+}
@@ -0,0 +1,41 @@
+#include "hashkernels.h"
+
+#ifdef HASH_KERNELS_X86
+
+#include <immintrin.h>
+
+// -- 4 voies sur des registres de 128 bits, le jeu d'instructions est activé pour ce seul fichier
+#ifdef __clang__
+#   pragma clang attribute push (__attribute__((target("sse4.1"))), apply_to = function)
+#else
+#   pragma GCC push_options
+#   pragma GCC target("sse4.1")
+#endif
+
+typedef __m128i vec_t;
+#define LANES           4
+#define KERNEL(name)    name##_sse41
+
+static inline vec_t v_set1(uint32_t x)                  { return _mm_set1_epi32((int)x); }
+static inline vec_t v_load(const uint32_t * p)          { return _mm_loadu_si128((const __m128i *)p); }
+static inline void  v_store(uint32_t * p, vec_t v)      { _mm_storeu_si128((__m128i *)p, v); }
+static inline vec_t v_add(vec_t a, vec_t b)             { return _mm_add_epi32(a, b); }
+static inline vec_t v_xor(vec_t a, vec_t b)             { return _mm_xor_si128(a, b); }
+static inline vec_t v_and(vec_t a, vec_t b)             { return _mm_and_si128(a, b); }
+static inline vec_t v_or(vec_t a, vec_t b)              { return _mm_or_si128(a, b); }
+static inline vec_t v_andnot(vec_t a, vec_t b)          { return _mm_andnot_si128(a, b); }
+static inline vec_t v_shl(vec_t x, int n)               { return _mm_sll_epi32(x, _mm_cvtsi32_si128(n)); }
+static inline vec_t v_shr(vec_t x, int n)               { return _mm_srl_epi32(x, _mm_cvtsi32_si128(n)); }
+static inline vec_t v_rotl(vec_t x, int n)              { return v_or(v_shl(x, n), v_shr(x, 32 - n)); }
+
+#include "hashkernels_impl.h"
+
+#ifdef __clang__
+#   pragma clang attribute pop
+#else
+#   pragma GCC pop_options
+#endif
+
+extern const HashKernel HashKernelSse41 = { "sse4.1", LANES, md5_sse41, sha1_sse41, sha256_sse41 };
+
+#endif // HASH_KERNELS_X86
@@ -5,21 +5,24 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QVariantMap>
+#include <QMap>
 
 bool Joiner::join(const QString &json)
 {
-    bool ok = false;
+    bool ok = true;
 
     // -- récupération des fragments
     QJsonParseError jsonError;
     QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8(), &jsonError);
     if(jsonError.error != QJsonParseError::NoError)
     {   _error  = "Failed to parse input json array in join !";
-        return ok;
+        return false;
     }
     QJsonArray fragments = doc.array();
 
-    // -- parsing fragments
+    // -- fusion des correspondances de tous les fragments (une entrée par cible)
+    QString firstMatch;
+    QMap<QString, QString> matches;
     foreach (QJsonValue frag, fragments)
     {   QVariantMap params;
         if(frag.isObject())
@@ -29,28 +32,48 @@ bool Joiner::join(const QString &json)
                 params = obj.value(CS_JSON_KEY_CALC_RESULT).toObject().toVariantMap();
                 // vérification de la présence d'un match
                 if(params.contains(PARAM_HAS_MATCH) && params.value(PARAM_HAS_MATCH).toBool())
-                {   // on stock le fragment contenant le match dans l'attribut resultat
-                    _result = QJsonDocument(obj).toJson(QJsonDocument::Compact);
-                    // on lève le drapeau
-                    ok = true;
-                    // on a trouvé le résultat on interrompt le traitement
-                    break;
+                {   if(firstMatch.isEmpty())
+                    {   firstMatch = params.value(PARAM_MATCH_STR).toString();
+                    }
+                    foreach(const QVariant & match, params.value(PARAM_MATCHES).toList())
+                    {   QVariantMap m = match.toMap();
+                        matches.insert(m.value(PARAM_TARGET).toString().toLower(), m.value(PARAM_MATCH_STR).toString());
+                    }
                 }
-                // sinon on continue
+                // on continue : d'autres fragments peuvent contenir d'autres cibles
             }
             else
             {   _error = QString("Missing '%1' field in calculation !")
                         .arg(CS_JSON_KEY_CALC_RESULT);
                 // on interrompt sur erreur
+                ok = false;
                 break;
             }
         }
         else
         {   _error = "Missing json object !";
             // on interrompt sur erreur
+            ok = false;
             break;
         }
     }
+
+    if(ok)
+    {   QVariantList list;
+        for(QMap<QString, QString>::const_iterator it = matches.constBegin(); it != matches.constEnd(); ++it)
+        {   QVariantMap match;
+            match.insert(PARAM_TARGET, it.key());
+            match.insert(PARAM_MATCH_STR, it.value());
+            list.append(match);
+        }
+        QVariantMap mapResult;
+        mapResult.insert(PARAM_HAS_MATCH, !firstMatch.isEmpty() || !matches.isEmpty());
+        mapResult.insert(PARAM_MATCH_STR, firstMatch);
+        mapResult.insert(PARAM_MATCHES, list);
+        QJsonObject response;
+        response.insert(CS_JSON_KEY_CALC_RESULT, QJsonObject::fromVariantMap(mapResult));
+        _result = QJsonDocument(response).toJson(QJsonDocument::Compact);
+    }
     return ok;
 }
 
@@ -0,0 +1,215 @@
+#include "keyspace.h"
+#include "bruteforce_specs.h"
+#include "candidategenerator.h"
+
+#include <algorithm>
+#include <limits>
+
+// -- jeux de caractères prédéfinis des masques
+#define MASK_LOWER      "abcdefghijklmnopqrstuvwxyz"
+#define MASK_UPPER      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+#define MASK_DIGITS     "0123456789"
+#define MASK_SPECIAL    " !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~"
+#define MASK_CUSTOM_MAX 4
+
+/**
+ * @brief Retourne le jeu prédéfini désigné par ?c, NULL si c n'en désigne aucun
+ */
+static const char * builtinCharset(QChar c)
+{
+    switch(c.toLatin1())
+    {   case 'l': return MASK_LOWER;
+        case 'u': return MASK_UPPER;
+        case 'd': return MASK_DIGITS;
+        case 's': return MASK_SPECIAL;
+        case 'a': return MASK_LOWER MASK_UPPER MASK_DIGITS MASK_SPECIAL;
+        default:  return NULL;
+    }
+}
+
+/**
+ * @brief Lit une longueur de candidat, entier positif ou nul
+ * @return faux si le paramètre n'est pas un tel entier
+ */
+static bool lengthParam(const QVariantMap & params, const char * param, uint & length)
+{
+    bool ok = false;
+    double value = params.value(param).toDouble(&ok);
+    if(!ok || value < 0 || value > std::numeric_limits<int>::max() || value != (int)value) return false;
+    length = (uint)value;
+    return true;
+}
+
+Keyspace::Keyspace() :
+    _error(""),
+    _segments(),
+    _offsets(1, 0)
+{
+}
+
+bool Keyspace::Build(const QVariantMap &params)
+{
+    if(params.contains(PARAM_MASK))
+    {   QStringList customs;
+        for(int i = 1; i <= MASK_CUSTOM_MAX; i++)
+        {   customs << params.value(QString(PARAM_CHARSET "%1").arg(i)).toString();
+        }
+        return BuildMask(params.value(PARAM_MASK).toString(), customs);
+    }
+    uint minLen, maxLen;
+    if(!lengthParam(params, PARAM_MIN_LEN, minLen))
+    {   _error = QString("Incorrect parameter : '%1' (expected a non-negative integer) !").arg(PARAM_MIN_LEN);
+        return false;
+    }
+    if(!lengthParam(params, PARAM_MAX_LEN, maxLen))
+    {   _error = QString("Incorrect parameter : '%1' (expected a non-negative integer) !").arg(PARAM_MAX_LEN);
+        return false;
+    }
+    if(minLen > maxLen)
+    {   _error = QString("Incorrect parameter : '%1' (must not be greater than '%2') !").arg(PARAM_MIN_LEN, PARAM_MAX_LEN);
+        return false;
+    }
+    return Build(params.value(PARAM_CHARSET).toString(), minLen, maxLen);
+}
+
+bool Keyspace::Build(const QString &charset, uint minLen, uint maxLen)
+{
+    QByteArray flat;
+    if(!possibleCharacters(charset, PARAM_CHARSET, flat)) return false;
+    // un segment par longueur, toutes les positions partagent le même jeu
+    for(uint length = minLen; length <= maxLen; length++)
+    {   if(!appendSegment(QVector<QByteArray>(length, flat), PARAM_MAX_LEN)) return false;
+    }
+    return true;
+}
+
+bool Keyspace::BuildMask(const QString &mask, const QStringList &customCharsets)
+{
+    // -- expansion des jeux personnalisés, qui peuvent utiliser les jeux prédéfinis
+    QVector<QByteArray> customs(MASK_CUSTOM_MAX);
+    for(int i = 0; i < MASK_CUSTOM_MAX && i < customCharsets.size(); i++)
+    {   const QString & custom = customCharsets.at(i);
+        if(custom.isEmpty()) continue;
+        QString expanded;
+        for(int c = 0; c < custom.length(); c++)
+        {   const char * builtin = custom.at(c) == '?' && c + 1 < custom.length() ? builtinCharset(custom.at(c + 1)) : NULL;
+            if(builtin)
+            {   expanded += builtin;
+                c++;
+            }
+            else if(custom.at(c) == '?' && c + 1 < custom.length() && custom.at(c + 1) == '?')
+            {   expanded += '?';
+                c++;
+            }
+            else
+            {   expanded += custom.at(c);
+            }
+        }
+        QString param = QString(PARAM_CHARSET "%1").arg(i + 1);
+        if(!possibleCharacters(expanded, param.toLatin1().constData(), customs[i])) return false;
+    }
+
+    // -- un jeu de caractères par position du masque
+    QVector<QByteArray> positions;
+    for(int c = 0; c < mask.length(); c++)
+    {   QByteArray flat;
+        if(mask.at(c) != '?')
+        {   if(!possibleCharacters(QString(mask.at(c)), PARAM_MASK, flat)) return false;
+        }
+        else if(c + 1 == mask.length())
+        {   _error = QString("Incorrect parameter : '%1' (trailing '?') !").arg(PARAM_MASK);
+            return false;
+        }
+        else
+        {   QChar placeholder = mask.at(++c);
+            const char * builtin = builtinCharset(placeholder);
+            int custom = placeholder.digitValue();
+            if(builtin)
+            {   possibleCharacters(builtin, PARAM_MASK, flat);
+            }
+            else if(placeholder == '?')
+            {   flat = "?";
+            }
+            else if(custom >= 1 && custom <= MASK_CUSTOM_MAX && !customs.at(custom - 1).isEmpty())
+            {   flat = customs.at(custom - 1);
+            }
+            else
+            {   _error = QString("Incorrect parameter : '%1' (unknown or empty placeholder '?%2') !").arg(PARAM_MASK).arg(placeholder);
+                return false;
+            }
+        }
+        positions.append(flat);
+    }
+    if(positions.isEmpty())
+    {   _error = QString("Incorrect parameter : '%1' !").arg(PARAM_MASK);
+        return false;
+    }
+    return appendSegment(positions, PARAM_MASK);
+}
+
+int Keyspace::maxLength() const
+{
+    // le plus long candidat d'un segment aligne le plus long symbole de chaque position
+    int longest = 0;
+    foreach(const QVector<QByteArray> & positions, _segments)
+    {   int length = 0;
+        foreach(const QByteArray & flat, positions)
+        {   length += CandidateGenerator::WidestSymbol(flat);
+        }
+        longest = qMax(longest, length);
+    }
+    return longest;
+}
+
+int Keyspace::LengthIndexOf(quint64 index) const
+{
+    int l = 0;
+    while(_offsets.at(l + 1) <= index) l++;
+    return l;
+}
+
+bool Keyspace::appendSegment(const QVector<QByteArray> &positions, const char * param)
+{
+    // nombre de candidats du segment : produit des tailles des jeux de chaque position
+    quint64 size = 1;
+    foreach(const QByteArray & flat, positions)
+    {   quint64 count = CandidateGenerator::SymbolCount(flat);
+        if(size > std::numeric_limits<quint64>::max() / count)
+        {   _error = QString("Incorrect parameters : keyspace for '%1' is too large !").arg(param);
+            return false;
+        }
+        size *= count;
+    }
+    if(_offsets.last() > std::numeric_limits<quint64>::max() - size)
+    {   _error = QString("Incorrect parameters : keyspace for '%1' is too large !").arg(param);
+        return false;
+    }
+    _segments.append(positions);
+    _offsets.append(_offsets.last() + size);
+    return true;
+}
+
+// A modifier au besoin, en fonction du format retenu pour le charset
+bool Keyspace::possibleCharacters(const QString &charset, const char * param, QByteArray & flat)
+{
+    if(charset.size() == 0)
+    { _error = QString("Incorrect parameter : '%1' !").arg(param);
+        return false;
+    }
+
+    // les caractères sont triés et dédoublonnés comme dans un std::set<QChar>, puis chacun
+    // est écrit à plat dans son encodage UTF-8 (un octet par symbole pour un jeu ASCII)
+    QVector<ushort> characters(charset.length());
+    for(int i = 0; i < charset.length(); i++)
+    {   characters[i] = charset.at(i).unicode();
+    }
+    std::sort(characters.begin(), characters.end());
+    characters.erase(std::unique(characters.begin(), characters.end()), characters.end());
+    flat.clear();
+    foreach(ushort c, characters)
+    {   if(c < 128) flat.append((char)c);
+        else flat.append(QString(QChar(c)).toUtf8());
+    }
+
+    return true;
+}
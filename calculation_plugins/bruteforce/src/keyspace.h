@@ -0,0 +1,94 @@
+#ifndef KEYSPACE_H
+#define KEYSPACE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QVariantMap>
+#include <QStringList>
+
+/**
+ * @brief Cette classe linéarise l'espace de clés d'un calcul bruteforce.
+ *
+ * L'espace est une suite de segments, chaque segment fixant le jeu de caractères de chaque
+ * position des candidats : en mode jeu de caractères, un segment par longueur de min_len à
+ * max_len ; en mode masque, un unique segment décrit par le masque. Les candidats sont
+ * numérotés de 0 à size() - 1 segment après segment, et au sein d'un segment le rang est
+ * l'écriture du candidat en base mixte. Le splitter découpe cet espace en intervalles
+ * [start_index, end_index) et le computer énumère un intervalle donné.
+ */
+class Keyspace
+{
+public:
+    Keyspace();
+
+    /**
+     * @brief Construit l'espace de clés depuis les paramètres d'un calcul : masque s'il est
+     * fourni (et jeux personnalisés charset1 à charset4), sinon charset, min_len et max_len
+     * @return faux si les paramètres sont incorrects, voir error()
+     */
+    bool Build(const QVariantMap & params);
+
+    /**
+     * @brief Construit l'espace de clés en mode jeu de caractères
+     * @param charset
+     *      Jeu de caractères demandé, il est trié et dédoublonné, chaque caractère est encodé en UTF-8
+     * @param minLen
+     *      Longueur minimale des candidats
+     * @param maxLen
+     *      Longueur maximale des candidats
+     * @return faux si les paramètres sont incorrects, voir error()
+     */
+    bool Build(const QString & charset, uint minLen, uint maxLen);
+
+    /**
+     * @brief Construit l'espace de clés en mode masque, à la manière de hashcat
+     * @param mask
+     *      Masque, par exemple "?u?l?l?l?d?d" : ?l minuscules, ?u majuscules, ?d chiffres,
+     *      ?s spéciaux, ?a les quatre précédents, ?1 à ?4 jeux personnalisés, ?? un '?'
+     *      littéral, tout autre caractère est littéral
+     * @param customCharsets
+     *      Jeux personnalisés ?1 à ?4, ils peuvent eux-mêmes contenir ?l, ?u, ?d, ?s et ?a
+     * @return faux si le masque est incorrect, voir error()
+     */
+    bool BuildMask(const QString & mask, const QStringList & customCharsets);
+
+    inline QString error() const { return _error; }
+
+    /**
+     * @brief Retourne le nombre total de candidats
+     */
+    inline quint64 size() const { return _offsets.last(); }
+
+    /**
+     * @brief Retourne le rang du premier candidat du l-ième segment
+     */
+    inline quint64 offset(int l) const { return _offsets.at(l); }
+
+    /**
+     * @brief Retourne les jeux de caractères de chaque position des candidats du l-ième segment,
+     *      symboles UTF-8 mis bout à bout (voir CandidateGenerator)
+     */
+    inline const QVector<QByteArray> & positions(int l) const { return _segments.at(l); }
+
+    /**
+     * @brief Retourne la longueur maximale des candidats en octets
+     */
+    int maxLength() const;
+
+    /**
+     * @brief Retourne l'indice de segment l tel que offset(l) <= index < offset(l + 1)
+     */
+    int LengthIndexOf(quint64 index) const;
+
+private:
+    QString _error;
+    QVector< QVector<QByteArray> > _segments;
+    // _offsets[l] est le rang du premier candidat du segment l, le dernier élément est la taille totale
+    QVector<quint64> _offsets;
+
+    bool possibleCharacters(const QString & charset, const char * param, QByteArray & flat);
+    bool appendSegment(const QVector<QByteArray> & positions, const char * param);
+};
+
+#endif // KEYSPACE_H
@@ -0,0 +1,112 @@
+#include "keyspacescheduler.h"
+
+#include <QMutexLocker>
+#include <limits>
+
+#define NO_CHUNK    std::numeric_limits<quint64>::max()
+
+KeyspaceScheduler::KeyspaceScheduler(quint64 begin, quint64 end, int workers, quint64 chunk) :
+    _ranges(new Range[workers > 0 ? workers : 1]),
+    _workers(workers > 0 ? workers : 1),
+    _chunk(chunk > 0 ? chunk : 1)
+{
+    // -- découpage initial en sous-plages contiguës de tailles égales (à une unité près)
+    quint64 total = end > begin ? end - begin : 0;
+    quint64 share = total / _workers;
+    quint64 rest = total % _workers;
+    quint64 cursor = begin;
+    for(int w = 0; w < _workers; ++w)
+    {   quint64 size = share + ((quint64)w < rest ? 1 : 0);
+        _ranges[w].next = cursor;
+        _ranges[w].end = cursor + size;
+        _ranges[w].busy = NO_CHUNK;
+        cursor += size;
+    }
+}
+
+bool KeyspaceScheduler::Take(int worker, quint64 &begin, quint64 &end)
+{
+    Range & own = _ranges[worker];
+    forever
+    {   {   QMutexLocker locker(&own.mutex);
+            // le morceau précédent de ce thread est traité
+            own.busy = NO_CHUNK;
+            if(own.next < own.end)
+            {   begin = own.next;
+                end = (own.end - own.next > _chunk) ? own.next + _chunk : own.end;
+                own.next = end;
+                own.busy = begin;
+                return true;
+            }
+        }
+        // -- plus rien en local : on tente de voler du travail à un autre thread
+        if(!steal(worker))
+        {   // plus rien nulle part : ce thread ne retient plus le point de reprise
+            QMutexLocker locker(&own.mutex);
+            own.next = own.end = NO_CHUNK;
+            return false;
+        }
+    }
+}
+
+quint64 KeyspaceScheduler::Checkpoint()
+{
+    /*
+     *  Le minimum porte aussi sur les plages épuisées (prudent) : seuls les threads qui ont
+     *  terminé en sont exclus. Un vol se fait sous les deux verrous, la moitié volée est donc
+     *  toujours dans l'une des deux plages.
+     */
+    quint64 mark = NO_CHUNK;
+    for(int w = 0; w < _workers; ++w)
+    {   QMutexLocker locker(&_ranges[w].mutex);
+        mark = qMin(mark, qMin(_ranges[w].next, _ranges[w].busy));
+    }
+    return mark;
+}
+
+bool KeyspaceScheduler::steal(int worker)
+{
+    forever
+    {   // -- choix de la victime : la plage restante la plus grande (lecture indicative)
+        int victim = -1;
+        quint64 best = 0;
+        for(int w = 0; w < _workers; ++w)
+        {   if(w == worker) continue;
+            QMutexLocker locker(&_ranges[w].mutex);
+            quint64 remaining = _ranges[w].end - _ranges[w].next;
+            if(remaining > best)
+            {   best = remaining;
+                victim = w;
+            }
+        }
+        if(victim < 0)
+        {   return false;
+        }
+        // -- partage : la victime garde la moitié basse, le voleur prend la moitié haute
+        // les deux plages sont verrouillées pour que la moitié volée reste visible de Checkpoint() ;
+        // tryLock évite l'interblocage de deux threads qui se volent mutuellement
+        QMutexLocker locker(&_ranges[worker].mutex);
+        Range & v = _ranges[victim];
+        if(!v.mutex.tryLock())
+        {   continue;
+        }
+        if(v.next >= v.end)
+        {   v.mutex.unlock();
+            continue; // la victime a terminé entre temps, on en cherche une autre
+        }
+        quint64 remaining = v.end - v.next;
+        quint64 begin;
+        if(remaining <= _chunk)
+        {   // trop petit pour être partagé : on prend tout
+            begin = v.next;
+        }
+        else
+        {   begin = v.next + remaining / 2;
+        }
+        _ranges[worker].next = begin;
+        _ranges[worker].end = v.end;
+        v.end = begin;
+        v.mutex.unlock();
+        return true;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef KEYSPACESCHEDULER_H
+#define KEYSPACESCHEDULER_H
+
+#include <QMutex>
+#include <QScopedArrayPointer>
+
+/**
+ * @brief Cette classe distribue une plage d'indices de l'espace de clés entre plusieurs threads.
+ *
+ * La plage [begin, end) est découpée en autant de sous-plages contiguës que de threads. Chaque
+ * thread consomme sa sous-plage par morceaux ; quand elle est épuisée, il vole la moitié haute
+ * de la sous-plage restante la plus grande. Les threads terminent ainsi ensemble même si
+ * certains morceaux sont plus longs à traiter que d'autres.
+ */
+class KeyspaceScheduler
+{
+public:
+    /**
+     * @brief Construit un ordonnanceur sur la plage [begin, end)
+     * @param workers
+     *      Nombre de threads qui consomment la plage
+     * @param chunk
+     *      Nombre maximal d'indices rendus par un appel à Take()
+     */
+    KeyspaceScheduler(quint64 begin, quint64 end, int workers, quint64 chunk);
+    ~KeyspaceScheduler(){}
+
+    /**
+     * @brief Donne le prochain morceau [begin, end) à traiter par le thread worker
+     * @return faux quand il ne reste plus rien à traiter nulle part
+     */
+    bool Take(int worker, quint64 & begin, quint64 & end);
+
+    /**
+     * @brief Retourne un indice tel que tous les indices inférieurs ont été traités : le morceau
+     * rendu par Take() est considéré traité au prochain appel de Take() par le même thread.
+     * La valeur est prudente (elle peut être inférieure au vrai point de reprise) et croissante.
+     */
+    quint64 Checkpoint();
+
+private:
+    /**
+     * @brief Vole la moitié de la plage restante la plus grande pour le thread worker
+     * @return faux si aucune plage ne peut être partagée
+     */
+    bool steal(int worker);
+
+    struct Range {
+        QMutex mutex;
+        quint64 next;
+        quint64 end;
+        // début du morceau en cours de traitement, NO_CHUNK si aucun
+        quint64 busy;
+    };
+
+    Q_DISABLE_COPY(KeyspaceScheduler)
+
+    QScopedArrayPointer<Range> _ranges;
+    int _workers;
+    quint64 _chunk;
+};
+
+#endif // KEYSPACESCHEDULER_H
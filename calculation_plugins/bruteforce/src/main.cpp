@@ -3,12 +3,13 @@
 #include "splitter.h"
 #include "joiner.h"
 #include "computer.h"
+#include "bencher.h"
 
 #include <iostream>
 #include <QUrl>
 #include <QString>
 #include <QStringList>
-#include <QTextStream>
+#include <QFile>
 #include <stdio.h>
 
 #include <QJsonDocument>
@@ -18,44 +19,72 @@
 
 void success(std::string response);
 void fail(std::string msg);
+static bool process(const QString & action, const QString & json, QString & response, bool framed);
+static void serve(QFile & in);
 static QJsonValue getParam(QString name, QString type);
 
 int main(int argc, char *argv[])
 {
-    // récupération des paramètres de calcul
-    QTextStream qtin(stdin);
-    QString action;
+    // récupération des paramètres de calcul, stdin est lu par un unique QFile
+    // pour que le mode worker puisse ensuite y lire des requêtes de taille connue
+    QFile in;
+    in.open(stdin, QIODevice::ReadOnly);
+    QString action = QString::fromUtf8(in.readLine()).trimmed();
     QString json;
-    qtin >> action;
-    for(QString line; !qtin.atEnd() && line != CS_EOF; line = qtin.readLine()) json += line;
+    forever
+    {   QByteArray line = in.readLine();
+        if(line.isEmpty()) break;
+        line.chop(line.endsWith('\n') ? 1 : 0);
+        if(line.trimmed() == CS_EOF) break;
+        json += QString::fromUtf8(line);
+    }
 
-    // traitement principal    
+    // traitement principal
+    if(QString::compare(action, CS_OP_WORKER, Qt::CaseInsensitive) == 0)
+    {   serve(in);
+        exit(EXIT_SUCCESS);
+    }
+    QString response;
+    if(process(action, json, response, false))
+    {   success(response.toStdString());
+    }
+    else
+    {   fail(response.toStdString());
+    }
+    // we should never reach this point
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Réalise l'opération demandée
+ * @param response
+ *      Résultat de l'opération en cas de succès, message d'erreur sinon
+ * @param framed
+ *      Vrai en mode worker : la réponse est encadrée, rien ne doit être écrit au fil de l'eau
+ * @return vrai en cas de succès
+ */
+static bool process(const QString & action, const QString & json, QString & response, bool framed)
+{
+    bool ok = false;
     if(QString::compare(action, CS_OP_JOIN, Qt::CaseInsensitive) == 0)
     {   Joiner joiner;
-        if(joiner.join(json))
-        {   success(QString(joiner.result()).toStdString());
-        }
-        else
-        {   fail(joiner.error().toStdString());
-        }
+        ok = joiner.join(json);
+        response = ok ? QString(joiner.result()) : joiner.error();
     }
     else if(QString::compare(action, CS_OP_SPLIT, Qt::CaseInsensitive) == 0)
     {   Splitter splitter;
-        if(splitter.split(json))
-        {   success(QString(splitter.result()).toStdString());
-        }
-        else
-        {   fail(splitter.error().toStdString());
-        }
+        ok = splitter.split(json, framed ? NULL : &std::cout);
+        response = ok ? QString(splitter.result()) : splitter.error();
     }
     else if(QString::compare(action, CS_OP_CALC, Qt::CaseInsensitive) == 0)
     {   Computer computer;
-        if(computer.compute(json))
-        {   success(QString(computer.result()).toStdString());
-        }
-        else
-        {   fail(computer.error().toStdString());
-        }
+        ok = computer.compute(json);
+        response = ok ? QString(computer.result()) : computer.error();
+    }
+    else if(QString::compare(action, CS_OP_BENCH, Qt::CaseInsensitive) == 0)
+    {   Bencher bencher;
+        ok = bencher.bench(json);
+        response = ok ? QString(bencher.result()) : bencher.error();
     }
     else if(QString::compare(action, CS_OP_PARAM, Qt::CaseInsensitive) == 0)
     {
@@ -64,20 +93,59 @@ int main(int argc, char *argv[])
         QJsonArray listParams;
 
         listParams += getParam(PARAM_CHARSET, CS_TYPE_STRING);
+        listParams += getParam(PARAM_MASK, CS_TYPE_STRING);
+        listParams += getParam(PARAM_WORDLIST, CS_TYPE_STRING);
         listParams += getParam(PARAM_MIN_LEN, CS_TYPE_INT);
         listParams += getParam(PARAM_MAX_LEN, CS_TYPE_INT);
         listParams += getParam(PARAM_HASH_F, CS_TYPE_STRING);
         listParams += getParam(PARAM_TARGET, CS_TYPE_STRING);
+        listParams += getParam(PARAM_THREADS, CS_TYPE_INT);
+        listParams += getParam(PARAM_FRAG_COUNT, CS_TYPE_INT);
+        listParams += getParam(PARAM_FRAG_SIZE, CS_TYPE_INT);
+        listParams += getParam(PARAM_HASH_RATE, CS_TYPE_DOUBLE);
 
         retDocument.setArray(listParams);
 
-        success(QString(retDocument.toJson(QJsonDocument::Compact)).toStdString());
+        response = QString(retDocument.toJson(QJsonDocument::Compact));
+        ok = true;
     }
     else
-    {   fail("Unknown operation.");
+    {   response = "Unknown operation.";
+    }
+    return ok;
+}
+
+/**
+ * @brief Mode worker : le processus reste en vie et traite les requêtes les unes après les
+ * autres. Une requête est une ligne "<op> <taille>" suivie de taille octets de JSON, une
+ * réponse une ligne "OK <taille>" ou "KO <taille>" suivie du résultat ou du message d'erreur.
+ * Les lignes PROGRESS et CHECKPOINT d'un calcul précèdent sa réponse. La fermeture de stdin
+ * arrête le worker.
+ */
+static void serve(QFile & in)
+{
+    std::cout << CS_WORKER_HELLO << std::endl;
+    forever
+    {   QList<QByteArray> header = in.readLine().trimmed().split(' ');
+        bool ok = header.size() == 2;
+        int size = ok ? header.at(1).toInt(&ok) : 0;
+        if(!ok || size < 0) break;
+        // une lecture sur un tube peut rendre moins d'octets que demandé
+        QByteArray json;
+        while(json.size() < size)
+        {   QByteArray chunk = in.read(size - json.size());
+            if(chunk.isEmpty()) break;
+            json += chunk;
+        }
+        if(json.size() != size) break;
+
+        QString response;
+        ok = process(QString::fromUtf8(header.at(0)), QString::fromUtf8(json), response, true);
+        QByteArray payload = response.toUtf8();
+        std::cout << (ok ? CS_WORKER_OK : CS_WORKER_KO) << " " << payload.size() << "\n";
+        std::cout.write(payload.constData(), payload.size());
+        std::cout.flush();
     }
-    // we should never reach this point
-    exit(EXIT_FAILURE);
 }
 
 void success(std::string response)
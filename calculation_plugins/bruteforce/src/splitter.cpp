@@ -1,6 +1,8 @@
 #include "splitter.h"
 #include "../../server/src/calculation/specs.h"
 #include "bruteforce_specs.h"
+#include "keyspace.h"
+#include "wordlist.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -8,10 +10,11 @@
 #include <QVariantMap>
 #include <iostream>
 
-#define AVG_TEST_PER_SEC            500     // pwd.s-1
-#define OPTIMAL_COMPUTATION_TIME    60      // s
+#define AVG_TEST_PER_SEC            10000000    // pwd.s-1, à défaut d'un débit mesuré (opération bench)
+#define OPTIMAL_COMPUTATION_TIME    60          // s
+#define MAX_FRAGMENTS               10000       // borne du découpage par défaut
 
-bool Splitter::split(const QString &json)
+bool Splitter::split(const QString &json, std::ostream * stream)
 {
     // drapeau ok initialisé baissé
     bool ok = false;
@@ -32,40 +35,119 @@ bool Splitter::split(const QString &json)
     {   _error = "Missing json object !";
     }
     // vérification des paramètres
-    if(params.contains(PARAM_MIN_LEN) &&
-       params.contains(PARAM_MAX_LEN))
+    if(params.contains(PARAM_WORDLIST) || params.contains(PARAM_MASK) ||
+       (params.contains(PARAM_MIN_LEN) && params.contains(PARAM_MAX_LEN)))
     {   /*
-         *  La fragmentation stupide pour le bruteforce consiste a distribuer
-         *  en donnant une taille de mot de passe pour chaque fragment
+         *  L'espace de clés est linéarisé (voir Keyspace) puis découpé en intervalles
+         *  [start_index, end_index) de tailles égales à une unité près : le coût d'un
+         *  fragment ne dépend plus de la longueur des mots de passe qu'il contient.
+         *  Un fichier de mots est découpé de la même façon en intervalles d'octets,
+         *  chaque borne étant repoussée au début de ligne suivant.
          */
-        // -- récupération des valeurs de min et max len dans les champs des paramètres
-        uint min_len = params.value(PARAM_MIN_LEN).toInt();
-        uint max_len = params.value(PARAM_MAX_LEN).toInt();
+        Keyspace keyspace;
+        Wordlist wordlist;
+        bool wordlistMode = params.contains(PARAM_WORDLIST);
+        quint64 total;
+        // -- taille moyenne d'un candidat dans l'intervalle découpé (octets par mot pour un fichier)
+        double unitsPerCandidate = 1.0;
+        if(wordlistMode)
+        {   if(!wordlist.Open(params.value(PARAM_WORDLIST).toString()))
+            {   _error = wordlist.error();
+                return false;
+            }
+            total = wordlist.size();
+            unitsPerCandidate = wordlist.AverageLineLength();
+        }
+        else
+        {   // -- linéarisation à partir du masque ou du charset et des min et max len
+            if(!keyspace.Build(params))
+            {   _error = keyspace.error();
+                return false;
+            }
+            total = keyspace.size();
+        }
+        if(total == 0)
+        {   _error = wordlistMode ?
+                        QString("Incorrect parameter : '%1' (empty file) !").arg(PARAM_WORDLIST) :
+                        QString("Incorrect parameters : '%1' must not be greater than '%2' !").arg(PARAM_MIN_LEN, PARAM_MAX_LEN);
+            return false;
+        }
+        // -- nombre de fragments : imposé, déduit de la taille imposée ou d'une durée de calcul optimale
+        quint64 count;
+        bool valid = true;
+        if(params.contains(PARAM_FRAG_COUNT))
+        {   count = params.value(PARAM_FRAG_COUNT).toULongLong(&valid);
+        }
+        else if(params.contains(PARAM_FRAG_SIZE))
+        {   quint64 size = params.value(PARAM_FRAG_SIZE).toULongLong(&valid);
+            count = valid && size > 0 ? total / size + (total % size ? 1 : 0) : 0;
+        }
+        else
+        {   // --- débit d'un client mesuré par l'opération bench si fourni
+            double rate = params.contains(PARAM_HASH_RATE) ? params.value(PARAM_HASH_RATE).toDouble(&valid) : AVG_TEST_PER_SEC;
+            valid = valid && rate >= 1.0;
+            quint64 size = valid ? qMax((quint64)(rate * OPTIMAL_COMPUTATION_TIME * unitsPerCandidate), (quint64)1) : 1;
+            count = qMin(total / size + (total % size ? 1 : 0), (quint64)MAX_FRAGMENTS);
+        }
+        if(!valid || count == 0)
+        {   _error = QString("Incorrect parameters : '%1', '%2' and '%3' must be positive numbers !").arg(PARAM_FRAG_COUNT, PARAM_FRAG_SIZE, PARAM_HASH_RATE);
+            return false;
+        }
+        count = qMin(count, total);
+        // -- un fragment par ligne si demandé, écrit dès sa création quand c'est possible
+        bool ndjson = doc.object().value(CS_JSON_KEY_SPLIT_FORMAT).toString() == CS_SPLIT_FORMAT_NDJSON;
+        QByteArray lines;
+        // -- les fragments de tête prennent un candidat de plus pour absorber le reste
+        quint64 share = total / count;
+        quint64 rest = total % count;
+        quint64 nominal = 0;
+        quint64 start = 0;
+        quint64 id = 0;
         QJsonArray fragments;
-        // -- pour chaque longueur entre min et max len, création d'un fragment
-        for (uint l = min_len; l <= max_len; ++l) {
+        for(quint64 f = 0; f < count; ++f) {
+            nominal += share + (f < rest ? 1 : 0);
+            quint64 end = wordlistMode ? wordlist.AlignToLine(nominal) : nominal;
+            // --- une ligne plus longue qu'un fragment absorbe la borne suivante
+            if(end <= start) continue;
             // --- récupération de l'objet calcul de base
             QJsonObject frag = doc.object();
+            frag.remove(CS_JSON_KEY_SPLIT_FORMAT);
             // --- identifiant du bloc de calcul
-            frag.insert(CS_JSON_KEY_FRAG_ID, QString::number(l-min_len+1));
-            // --- récupération des paramètres du calcul de base
+            frag.insert(CS_JSON_KEY_FRAG_ID, QString::number(++id));
+            // --- une correspondance pour chaque cible termine le calcul
+            frag.insert(CS_JSON_KEY_COMPLETION, QString(CS_COMPLETION_FIRST));
+            // --- la fusion est associative : le serveur peut fusionner les résultats par groupes
+            frag.insert(CS_JSON_KEY_JOIN, QString(CS_JOIN_INCREMENTAL));
+            // --- récupération des paramètres du calcul de base, sans ceux du découpage
             QVariantMap frag_params = params;
-            // --- modification des champs min et max len dans les paramètre
-            frag_params.insert(PARAM_MIN_LEN, l);
-            frag_params.insert(PARAM_MAX_LEN, l);
+            frag_params.remove(PARAM_FRAG_COUNT);
+            frag_params.remove(PARAM_FRAG_SIZE);
+            frag_params.remove(PARAM_HASH_RATE);
+            // --- intervalle de l'espace de clés, en chaîne car un double JSON ne représente pas tout quint64
+            frag_params.insert(PARAM_START_INDEX, QString::number(start));
+            frag_params.insert(PARAM_END_INDEX, QString::number(end));
             // --- modification du champ paramètre
             frag.insert(CS_JSON_KEY_CALC_PARAMS, QJsonObject::fromVariantMap(frag_params));
-            // --- insertion du fragment dans la liste
-            fragments.append(frag);
+            // --- insertion du fragment dans la liste ou écriture de sa ligne
+            if(!ndjson)
+            {   fragments.append(frag);
+            }
+            else if(stream)
+            {   *stream << QJsonDocument(frag).toJson(QJsonDocument::Compact).constData() << std::endl;
+            }
+            else
+            {   lines.append(QJsonDocument(frag).toJson(QJsonDocument::Compact)).append('\n');
+            }
+            start = end;
         }
         // -- insertion des fragment dans l'attribut résultat de l'objet splitter
-        _result = QJsonDocument(fragments).toJson(QJsonDocument::Compact);
+        _result = ndjson ? QString(lines) : QString(QJsonDocument(fragments).toJson(QJsonDocument::Compact));
         // on lève le drapeau
         ok = true;
     }
     else
-    {   _error = QString("Missing fields '%1' and '%2' in field '%3' calculation !")
-                .arg(PARAM_MAX_LEN, PARAM_MAX_LEN, CS_JSON_KEY_CALC_PARAMS);
+    {   _error = QString("Missing fields '%1' and '%2', '%3' or '%4' in field '%5' calculation !")
+                .arg(PARAM_MIN_LEN, PARAM_MAX_LEN, PARAM_MASK, PARAM_WORDLIST, CS_JSON_KEY_CALC_PARAMS);
     }
     return ok;
 }
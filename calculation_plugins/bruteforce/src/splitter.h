@@ -2,13 +2,20 @@
 #define SPLITTER_H
 
 #include <QString>
+#include <ostream>
 
 class Splitter
 {
 public:
     Splitter();
 
-    bool split(const QString & json);
+    /**
+     * @brief Découpe le calcul en fragments : un tableau JSON par défaut, un fragment JSON par
+     *      ligne si le calcul demande le format NDJSON
+     * @param stream
+     *      Si non NULL, les lignes NDJSON y sont écrites au fil du découpage au lieu du résultat
+     */
+    bool split(const QString & json, std::ostream * stream = NULL);
     inline QString error() const { return _error; }
     inline QString result() const { return _result; }
 
@@ -0,0 +1,109 @@
+#include "targetset.h"
+#include "bruteforce_specs.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QVariantMap>
+#include <algorithm>
+#include <ctype.h>
+
+#define FILTER_MIN_BITS     16      // 8 Ko, tient dans le cache L1
+#define FILTER_MAX_BITS     28      // 32 Mo
+#define FILTER_LOAD         4       // bits de filtre par cible (log2)
+
+TargetSet::TargetSet() :
+    _error(""),
+    _digest_length(0),
+    _digests(),
+    _prefixes(),
+    _filter(),
+    _filter_shift(64),
+    _digest_data(NULL),
+    _prefix_data(NULL),
+    _filter_bits(NULL)
+{
+}
+
+bool TargetSet::Build(const QVariant &target, int digestLength)
+{
+    _digest_length = digestLength;
+
+    // -- récupération des empreintes hexadécimales selon la forme du paramètre
+    QStringList hexes;
+    if(target.type() == QVariant::List)
+    {   foreach(const QVariant & value, target.toList())
+        {   hexes << value.toString();
+        }
+    }
+    else if(target.type() == QVariant::Map)
+    {   QFile file(target.toMap().value(PARAM_TARGET_FILE).toString());
+        if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {   _error = QString("Incorrect parameter : '%1' (can't open file '%2') !").arg(PARAM_TARGET, file.fileName());
+            return false;
+        }
+        QTextStream in(&file);
+        while(!in.atEnd())
+        {   QString line = in.readLine().trimmed();
+            if(!line.isEmpty()) hexes << line;
+        }
+    }
+    else
+    {   hexes << target.toString();
+    }
+    if(hexes.isEmpty())
+    {   _error = QString("Incorrect parameter : '%1' (no target) !").arg(PARAM_TARGET);
+        return false;
+    }
+
+    // -- décodage, tri et dédoublonnage
+    QVector<QByteArray> digests;
+    digests.reserve(hexes.size());
+    foreach(const QString & hex, hexes)
+    {   QByteArray digest;
+        if(!decode(hex, digest)) return false;
+        digests.append(digest);
+    }
+    std::sort(digests.begin(), digests.end());
+    digests.erase(std::unique(digests.begin(), digests.end()), digests.end());
+
+    _digests.clear();
+    _digests.reserve(digests.size() * _digest_length);
+    _prefixes.resize(digests.size());
+    for(int i = 0; i < digests.size(); i++)
+    {   _digests.append(digests.at(i));
+        _prefixes[i] = qFromBigEndian<quint64>((const uchar *)digests.at(i).constData());
+    }
+
+    // -- filtre : environ 2^FILTER_LOAD bits par cible, indexés par les premiers bits de l'empreinte
+    int bits = FILTER_MIN_BITS;
+    while(bits < FILTER_MAX_BITS && (quint64)digests.size() << FILTER_LOAD > (Q_UINT64_C(1) << bits)) bits++;
+    _filter_shift = 64 - bits;
+    _filter.fill(0, 1 << (bits - 6));
+    foreach(quint64 prefix, _prefixes)
+    {   quint64 slot = prefix >> _filter_shift;
+        _filter[slot >> 6] |= Q_UINT64_C(1) << (slot & 63);
+    }
+
+    _digest_data = _digests.constData();
+    _prefix_data = _prefixes.constData();
+    _filter_bits = _filter.constData();
+    return true;
+}
+
+bool TargetSet::decode(const QString &hex, QByteArray &digest)
+{
+    if(hex.length() != 2 * _digest_length)
+    {   _error = QString("Incorrect parameter : '%1' (expected %2 hexadecimal digits) !").arg(PARAM_TARGET).arg(2 * _digest_length);
+        return false;
+    }
+    for(int i = 0; i < hex.length(); i++)
+    {   ushort c = hex.at(i).unicode();
+        if(c >= 128 || !isxdigit(c))
+        {   _error = QString("Incorrect parameter : '%1' (not an hexadecimal string) !").arg(PARAM_TARGET);
+            return false;
+        }
+    }
+    digest = QByteArray::fromHex(hex.toLatin1());
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef TARGETSET_H
+#define TARGETSET_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QVariant>
+#include <QtEndian>
+#include <string.h>
+
+/**
+ * @brief Cette classe contient l'ensemble des empreintes cibles d'un calcul bruteforce.
+ *
+ * Les empreintes brutes sont triées dans un tableau contigu. Un filtre (un bit par valeur
+ * des premiers bits de l'empreinte) rejette presque tous les candidats sans accès au tableau ;
+ * les autres sont confirmés par une recherche dichotomique sur les 8 premiers octets puis
+ * une comparaison mémoire du reste.
+ */
+class TargetSet
+{
+public:
+    TargetSet();
+
+    /**
+     * @brief Décode les cibles
+     * @param target
+     *      Empreinte hexadécimale, tableau d'empreintes ou objet {"file":"<chemin>"} désignant
+     *      un fichier contenant une empreinte par ligne
+     * @param digestLength
+     *      Taille en octets des empreintes de l'algorithme choisi (au moins 8)
+     * @return faux si une cible est incorrecte, voir error()
+     */
+    bool Build(const QVariant & target, int digestLength);
+
+    inline QString error() const { return _error; }
+
+    /**
+     * @brief Retourne le nombre de cibles distinctes
+     */
+    inline int count() const { return _prefixes.size(); }
+
+    /**
+     * @brief Retourne vrai si l'empreinte brute fait partie des cibles
+     */
+    inline bool contains(const char * digest) const
+    {
+        quint64 prefix = qFromBigEndian<quint64>((const uchar *)digest);
+        quint64 slot = prefix >> _filter_shift;
+        if(!(_filter_bits[slot >> 6] & (Q_UINT64_C(1) << (slot & 63))))
+        {   return false;
+        }
+        // -- confirmation : première cible de même préfixe puis comparaison complète
+        int lo = 0, hi = _prefixes.size();
+        while(lo < hi)
+        {   int mid = (lo + hi) / 2;
+            if(_prefix_data[mid] < prefix) lo = mid + 1;
+            else hi = mid;
+        }
+        for(; lo < _prefixes.size() && _prefix_data[lo] == prefix; lo++)
+        {   if(memcmp(digest + 8, _digest_data + lo * _digest_length + 8, _digest_length - 8) == 0)
+            {   return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    QString _error;
+    int _digest_length;
+    // empreintes triées bout à bout et leurs 8 premiers octets (gros-boutiste) dans le même ordre
+    QByteArray _digests;
+    QVector<quint64> _prefixes;
+    QVector<quint64> _filter;
+    int _filter_shift;
+    // accès directs aux données des conteneurs ci-dessus pour la boucle chaude
+    const char * _digest_data;
+    const quint64 * _prefix_data;
+    const quint64 * _filter_bits;
+
+    bool decode(const QString & hex, QByteArray & digest);
+};
+
+#endif // TARGETSET_H
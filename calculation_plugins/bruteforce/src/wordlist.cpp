@@ -0,0 +1,82 @@
+#include "wordlist.h"
+#include "bruteforce_specs.h"
+
+#include <string.h>
+
+#define ALIGN_BLOCK     65536       // octets lus à la fois pour trouver une fin de ligne
+#define SAMPLE_SIZE     1048576     // octets lus pour estimer la taille moyenne d'une ligne
+
+Wordlist::Wordlist() :
+    _error(""),
+    _file(),
+    _size(0),
+    _map(NULL),
+    _map_begin(0)
+{
+}
+
+Wordlist::~Wordlist()
+{
+    if(_map)
+    {   _file.unmap(_map);
+    }
+}
+
+bool Wordlist::Open(const QString &path)
+{
+    _file.setFileName(path);
+    if(!_file.open(QIODevice::ReadOnly))
+    {   _error = QString("Incorrect parameter : '%1' (can't open file '%2') !").arg(PARAM_WORDLIST, path);
+        return false;
+    }
+    _size = _file.size();
+    return true;
+}
+
+quint64 Wordlist::AlignToLine(quint64 offset)
+{
+    if(offset == 0 || offset >= _size)
+    {   return qMin(offset, _size);
+    }
+    // -- on cherche le premier '\n' à partir de l'octet précédant offset
+    QByteArray block;
+    quint64 cursor = offset - 1;
+    while(cursor < _size)
+    {   if(!_file.seek(cursor)) break;
+        block = _file.read(ALIGN_BLOCK);
+        if(block.isEmpty()) break;
+        const char * eol = (const char *)memchr(block.constData(), '\n', block.size());
+        if(eol)
+        {   return cursor + (eol - block.constData()) + 1;
+        }
+        cursor += block.size();
+    }
+    return _size;
+}
+
+double Wordlist::AverageLineLength()
+{
+    if(!_file.seek(0)) return 1.0;
+    QByteArray sample = _file.read(SAMPLE_SIZE);
+    int lines = sample.count('\n');
+    if(lines == 0) return qMax(sample.size(), 1);
+    return (double)sample.size() / lines;
+}
+
+bool Wordlist::Map(quint64 begin, quint64 end)
+{
+    if(_map)
+    {   _file.unmap(_map);
+        _map = NULL;
+    }
+    _map_begin = begin;
+    if(end <= begin)
+    {   return true;
+    }
+    _map = _file.map(begin, end - begin);
+    if(!_map)
+    {   _error = QString("Can't map '%1' : %2 !").arg(_file.fileName(), _file.errorString());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef WORDLIST_H
+#define WORDLIST_H
+
+#include <QString>
+#include <QFile>
+
+/**
+ * @brief Cette classe donne accès à un fichier de mots (un mot par ligne) sans le charger en mémoire.
+ *
+ * Le splitter découpe le fichier en intervalles d'octets [start_index, end_index) alignés sur
+ * les débuts de ligne ; le computer projette son intervalle en mémoire (mmap) et hache les
+ * mots directement dans la projection.
+ */
+class Wordlist
+{
+public:
+    Wordlist();
+    ~Wordlist();
+
+    /**
+     * @brief Ouvre le fichier de mots en lecture
+     * @return faux si le fichier ne peut être ouvert, voir error()
+     */
+    bool Open(const QString & path);
+
+    inline QString error() const { return _error; }
+
+    /**
+     * @brief Retourne la taille du fichier en octets
+     */
+    inline quint64 size() const { return _size; }
+
+    /**
+     * @brief Retourne le premier début de ligne situé à ou après offset (ou la taille du fichier)
+     */
+    quint64 AlignToLine(quint64 offset);
+
+    /**
+     * @brief Estime la taille moyenne d'une ligne, fin de ligne comprise, sur le début du fichier
+     */
+    double AverageLineLength();
+
+    /**
+     * @brief Projette en mémoire l'intervalle [begin, end) du fichier
+     * @return faux si la projection échoue, voir error()
+     */
+    bool Map(quint64 begin, quint64 end);
+
+    /**
+     * @brief Retourne un pointeur tel que at()[offset] soit l'octet offset du fichier, pour
+     * tout offset de l'intervalle projeté
+     */
+    inline const char * at() const { return (const char *)_map - _map_begin; }
+
+private:
+    Q_DISABLE_COPY(Wordlist)
+
+    QString _error;
+    QFile _file;
+    quint64 _size;
+    uchar * _map;
+    quint64 _map_begin;
+};
+
+#endif // WORDLIST_H
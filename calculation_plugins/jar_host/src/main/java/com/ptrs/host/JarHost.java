@@ -0,0 +1,362 @@
+package com.ptrs.host;
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.io.PrintStream;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.lang.reflect.Modifier;
+import java.net.URL;
+import java.net.URLClassLoader;
+import java.nio.charset.StandardCharsets;
+import java.security.Permission;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.jar.Attributes;
+import java.util.jar.JarEntry;
+import java.util.jar.JarFile;
+import java.util.jar.Manifest;
+
+/**
+ * Resident host for JAR plugins: the plugin is loaded once in this JVM and its operations are
+ * received through the worker protocol (see README), so class loading and JIT stay warm from one
+ * operation to the next.
+ *
+ * The plugin is called through its main class' static execute(String action, String json) method
+ * if it has one, otherwise through its main method with redirected standard streams.
+ */
+public class JarHost {
+
+	private static final String END_OF_FILE = "EOF";
+	private static final String WORKER = "worker";
+	private static final String WORKER_HELLO = "WORKER 1";
+	private static final String WORKER_OK = "OK";
+	private static final String WORKER_KO = "KO";
+	private static final String PROGRESS = "PROGRESS ";
+	private static final String CHECKPOINT = "CHECKPOINT ";
+
+	// Eclipse "jar in jar" runnable archives
+	private static final String RSRC_MAIN_CLASS = "Rsrc-Main-Class";
+	private static final String RSRC_CLASS_PATH = "Rsrc-Class-Path";
+
+	private final PrintStream protocol;
+	private final InputStream input;
+	private final ExitTrap exitTrap;
+	private ClassLoader loader;
+	private Method execute;
+	private Method main;
+
+	public static void main(String[] args) {
+		if(args.length != 1) {
+			System.err.println("Usage : java -jar ptrs-jarhost.jar <plugin.jar>");
+			System.exit(1);
+		}
+		JarHost host = new JarHost();
+		try {
+			host.load(new File(args[0]));
+		}
+		catch (Exception e) {
+			System.err.println("Can't load plugin '" + args[0] + "' : " + e);
+			System.exit(1);
+		}
+		// without exit trap, a plugin calling System.exit() can't be hosted
+		if(host.execute == null && host.exitTrap == null) {
+			System.err.println("Plugin has no execute(String, String) method and System.exit() can't be trapped");
+			System.exit(1);
+		}
+		try {
+			host.serve();
+		}
+		catch (IOException e) {
+			System.err.println("An error occured while reading standard input : " + e.getMessage());
+			System.exit(1);
+		}
+		System.exit(0);
+	}
+
+	private JarHost() {
+		protocol = System.out;
+		input = System.in;
+		exitTrap = ExitTrap.install();
+	}
+
+	private void load(File jar) throws Exception {
+		List<URL> urls = new ArrayList<URL>();
+		urls.add(jar.toURI().toURL());
+		String mainClass;
+		try (JarFile jarFile = new JarFile(jar)) {
+			Manifest manifest = jarFile.getManifest();
+			if(manifest == null) {
+				throw new IOException("missing manifest");
+			}
+			Attributes attributes = manifest.getMainAttributes();
+			mainClass = attributes.getValue(RSRC_MAIN_CLASS);
+			if(mainClass != null) {
+				// nested libraries are extracted once, next to each other
+				String classPath = attributes.getValue(RSRC_CLASS_PATH);
+				for(String entry : (classPath == null ? new String[0] : classPath.trim().split("\\s+"))) {
+					JarEntry nested = jarFile.getJarEntry(entry);
+					if(nested != null && !nested.isDirectory()) {
+						urls.add(extract(jarFile, nested).toURI().toURL());
+					}
+				}
+			}
+			else {
+				mainClass = attributes.getValue(Attributes.Name.MAIN_CLASS);
+			}
+		}
+		if(mainClass == null) {
+			throw new IOException("no main class in manifest");
+		}
+		loader = new URLClassLoader(urls.toArray(new URL[urls.size()]), ClassLoader.getSystemClassLoader().getParent());
+		Class<?> pluginClass = Class.forName(mainClass, true, loader);
+		try {
+			execute = pluginClass.getMethod("execute", String.class, String.class);
+			if(!Modifier.isStatic(execute.getModifiers()) || execute.getReturnType() != String.class) {
+				execute = null;
+			}
+		}
+		catch (NoSuchMethodException e) {
+			execute = null;
+		}
+		main = pluginClass.getMethod("main", String[].class);
+	}
+
+	private static File extract(JarFile jarFile, JarEntry entry) throws IOException {
+		File file = File.createTempFile("ptrs-jarhost-", "-" + new File(entry.getName()).getName());
+		file.deleteOnExit();
+		try (InputStream in = jarFile.getInputStream(entry); OutputStream out = new FileOutputStream(file)) {
+			byte[] buffer = new byte[64 * 1024];
+			int read;
+			while((read = in.read(buffer)) > 0) {
+				out.write(buffer, 0, read);
+			}
+		}
+		return file;
+	}
+
+	private void serve() throws IOException {
+		// announcement request : "worker" then "EOF"
+		String line = readLine();
+		if(!WORKER.equals(line)) {
+			System.err.println("Worker mode wasn't requested, exiting.");
+			System.exit(1);
+		}
+		while((line = readLine()) != null && !line.equals(END_OF_FILE)) {
+		}
+		protocol.print(WORKER_HELLO + "\n");
+		protocol.flush();
+		// requests : "<op> <size>" then size bytes of JSON, until standard input is closed
+		while((line = readLine()) != null) {
+			String[] header = line.trim().split(" ");
+			if(header.length != 2) {
+				continue;
+			}
+			byte[] json = readFully(Integer.parseInt(header[1]));
+			if(json == null) {
+				break;
+			}
+			call(header[0], new String(json, StandardCharsets.UTF_8));
+		}
+	}
+
+	private void call(String action, String json) {
+		ResultStream result = new ResultStream(protocol);
+		ByteArrayOutputStream error = new ByteArrayOutputStream();
+		PrintStream out = System.out, err = System.err;
+		InputStream in = System.in;
+		ClassLoader contextLoader = Thread.currentThread().getContextClassLoader();
+		boolean ok = false;
+		try {
+			System.setOut(new PrintStream(result, true));
+			System.setErr(new PrintStream(error, true));
+			Thread.currentThread().setContextClassLoader(loader);
+			if(execute != null) {
+				String output = (String) execute.invoke(null, action, json);
+				if(output != null) {
+					result.write(output.getBytes(StandardCharsets.UTF_8));
+					ok = true;
+				}
+			}
+			else {
+				String request = action + "\n" + json + "\n" + END_OF_FILE + "\n";
+				System.setIn(new ByteArrayInputStream(request.getBytes(StandardCharsets.UTF_8)));
+				ok = runMain();
+			}
+		}
+		catch (InvocationTargetException e) {
+			System.err.println(e.getCause());
+		}
+		catch (Exception e) {
+			System.err.println(e);
+		}
+		finally {
+			System.out.flush();
+			System.setOut(out);
+			System.setErr(err);
+			System.setIn(in);
+			Thread.currentThread().setContextClassLoader(contextLoader);
+		}
+		if(ok) {
+			respond(WORKER_OK, result.toByteArray());
+		}
+		else {
+			respond(WORKER_KO, error.toByteArray());
+		}
+	}
+
+	private boolean runMain() throws Exception {
+		exitTrap.enter();
+		try {
+			main.invoke(null, (Object) new String[0]);
+			return true;
+		}
+		catch (InvocationTargetException e) {
+			if(e.getCause() instanceof ExitException) {
+				return ((ExitException) e.getCause()).status == 0;
+			}
+			throw e;
+		}
+		finally {
+			exitTrap.leave();
+		}
+	}
+
+	private void respond(String status, byte[] payload) {
+		protocol.print(status + " " + payload.length + "\n");
+		protocol.write(payload, 0, payload.length);
+		protocol.flush();
+	}
+
+	private String readLine() throws IOException {
+		ByteArrayOutputStream line = new ByteArrayOutputStream();
+		int c;
+		while((c = input.read()) >= 0 && c != '\n') {
+			if(c != '\r') {
+				line.write(c);
+			}
+		}
+		if(c < 0 && line.size() == 0) {
+			return null;
+		}
+		return new String(line.toByteArray(), StandardCharsets.UTF_8);
+	}
+
+	private byte[] readFully(int size) throws IOException {
+		byte[] data = new byte[size];
+		int offset = 0;
+		while(offset < size) {
+			int read = input.read(data, offset, size - offset);
+			if(read < 0) {
+				return null;
+			}
+			offset += read;
+		}
+		return data;
+	}
+
+	/**
+	 * Collects a plugin's standard output : progress and checkpoint lines are forwarded as they
+	 * are written, everything else is kept for the response.
+	 */
+	private static class ResultStream extends OutputStream {
+
+		private final PrintStream protocol;
+		private final ByteArrayOutputStream result = new ByteArrayOutputStream();
+		private final ByteArrayOutputStream line = new ByteArrayOutputStream();
+
+		ResultStream(PrintStream protocol) {
+			this.protocol = protocol;
+		}
+
+		@Override
+		public void write(int b) {
+			line.write(b);
+			if(b == '\n') {
+				endLine();
+			}
+		}
+
+		@Override
+		public void flush() {
+			// an incomplete line can still be a progress line, it waits for its end
+		}
+
+		byte[] toByteArray() {
+			result.write(line.toByteArray(), 0, line.size());
+			line.reset();
+			return result.toByteArray();
+		}
+
+		private void endLine() {
+			String text = new String(line.toByteArray(), StandardCharsets.UTF_8);
+			if(text.startsWith(PROGRESS) || text.startsWith(CHECKPOINT)) {
+				protocol.print(text);
+				protocol.flush();
+			}
+			else {
+				result.write(line.toByteArray(), 0, line.size());
+			}
+			line.reset();
+		}
+	}
+
+	/**
+	 * Turns System.exit() into an exception while a plugin's main method runs.
+	 */
+	private static class ExitTrap extends SecurityManager {
+
+		private volatile boolean active = false;
+
+		static ExitTrap install() {
+			try {
+				ExitTrap trap = new ExitTrap();
+				System.setSecurityManager(trap);
+				return trap;
+			}
+			catch (UnsupportedOperationException | SecurityException e) {
+				// recent JVMs don't allow a security manager to be installed at runtime
+				return null;
+			}
+		}
+
+		void enter() {
+			active = true;
+		}
+
+		void leave() {
+			active = false;
+		}
+
+		@Override
+		public void checkExit(int status) {
+			if(active) {
+				throw new ExitException(status);
+			}
+		}
+
+		@Override
+		public void checkPermission(Permission perm) {
+		}
+
+		@Override
+		public void checkPermission(Permission perm, Object context) {
+		}
+	}
+
+	private static class ExitException extends SecurityException {
+
+		private static final long serialVersionUID = 1L;
+		private final int status;
+
+		ExitException(int status) {
+			super("System.exit(" + status + ") called by plugin");
+			this.status = status;
+		}
+	}
+}
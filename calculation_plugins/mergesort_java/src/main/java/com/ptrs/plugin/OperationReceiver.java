@@ -35,24 +35,12 @@ public class OperationReceiver {
 		}
 		
 		String jsonResult = null;
-		action = action.toLowerCase();
-		switch(action) {
-			case Action.JOIN:
-				jsonResult = Merger.mergeFromJson(json);
-				break;
-			case Action.SPLIT:
-				jsonResult = Splitter.splitFromJson(json);
-				break;
-			case Action.COMPUTE:
-				jsonResult = Calculator.mergeSortFromJson(json);
-				break;
-			case Action.GET_PARAMS:
-				jsonResult = Action.getAcceptedParameters();
-				break;
-			default:
-				// Undefined action
-				System.err.println("Undefined action, exiting. List of actions are split, calc, join, and get_params.");
-				System.exit(1);
+		try {
+			jsonResult = execute(action, json);
+		}
+		catch (IllegalArgumentException e) {
+			System.err.println(e.getMessage());
+			System.exit(1);
 		}
 		
 		if(jsonResult != null) {
@@ -65,4 +53,27 @@ public class OperationReceiver {
 		// Exit on success
 		System.exit(0);
 	}
+	
+	/**
+	 * Runs an operation without leaving the current JVM, this is the entry point used by the
+	 * resident JAR host.
+	 * @param action split, calc, join or get_params
+	 * @param json the operation's input
+	 * @return the JSON result, or null if the operation failed (the reason is on the error stream)
+	 * @throws IllegalArgumentException if the action is undefined
+	 */
+	public static String execute(String action, String json) {
+		switch(action.toLowerCase()) {
+			case Action.JOIN:
+				return Merger.mergeFromJson(json);
+			case Action.SPLIT:
+				return Splitter.splitFromJson(json);
+			case Action.COMPUTE:
+				return Calculator.mergeSortFromJson(json);
+			case Action.GET_PARAMS:
+				return Action.getAcceptedParameters();
+			default:
+				throw new IllegalArgumentException("Undefined action, exiting. List of actions are split, calc, join, and get_params.");
+		}
+	}
 }
@@ -3,9 +3,12 @@ package com.ptrs.util;
 public class CalculationBlock {
 	
 	private static final String BINARY_NAME = "ptrs-mergesort.jar";
+	/** Merged results can be merged again : the server may join them by groups as they arrive */
+	private static final String INCREMENTAL_JOIN = "incremental";
 	
 	private String bin;
 	private String fragmentId;
+	private String join;
 	
 	private CalculationBlockParams params;
 	
@@ -21,6 +24,7 @@ public class CalculationBlock {
 		super();
 		this.bin = bin;
 		this.fragmentId = fragmentId;
+		this.join = INCREMENTAL_JOIN;
 		this.params = params;
 	}
 
@@ -40,6 +44,14 @@ public class CalculationBlock {
 		this.fragmentId = fragmentId;
 	}
 
+	public String getJoin() {
+		return join;
+	}
+
+	public void setJoin(String join) {
+		this.join = join;
+	}
+
 	public CalculationBlockParams getParams() {
 		return params;
 	}
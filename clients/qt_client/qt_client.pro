@@ -35,7 +35,13 @@ HEADERS += src/const.h \
            src/network/networkmanager.h \
     src/applicationmanager.h \
     src/console/consolehandler.h \
-    src/plugins/pluginprocess.h
+    src/plugins/pluginprocess.h \
+    src/plugins/pluginworker.h \
+    src/calculation/pluginabi.h \
+    src/plugins/libraryplugin.h \
+    src/plugins/librarytask.h \
+    src/plugins/plugindownload.h \
+    src/plugins/pluginoutput.h
 
 SOURCES += src/main.cpp \
            src/calculation/calculation.cpp \
@@ -52,7 +58,12 @@ SOURCES += src/main.cpp \
             src/network/networkmanager.cpp \
     src/applicationmanager.cpp \
     src/console/consolehandler.cpp \
-    src/plugins/pluginprocess.cpp
+    src/plugins/pluginprocess.cpp \
+    src/plugins/pluginworker.cpp \
+    src/plugins/libraryplugin.cpp \
+    src/plugins/librarytask.cpp \
+    src/plugins/plugindownload.cpp \
+    src/plugins/pluginoutput.cpp
 
 QT += network
 
@@ -3,8 +3,15 @@
 #include "utils/logger.h"
 #include "console/consolehandler.h"
 #include "plugins/pluginmanager.h"
+#include "plugins/pluginoutput.h"
 #include "network/clientsession.h"
 #include "network/networkmanager.h"
+
+#include <QCoreApplication>
+
+#define OPT_ISOLATE_PLUGINS "--isolate-plugins"
+#define OPT_OUTPUT_MEMORY "--output-memory"
+
 ApplicationManager ApplicationManager::_instance;
 
 void ApplicationManager::Init()
@@ -33,6 +40,23 @@ void ApplicationManager::Init()
     LOG_INFO("Initialisation des composants...");
     // -- initialisation des composants
     PluginManager::getInstance().Init();
+    // --- plugins bibliothèque exécutés hors du client : --isolate-plugins
+    if(qApp->arguments().contains(OPT_ISOLATE_PLUGINS))
+    {   PluginManager::getInstance().SetIsolatePlugins(true);
+    }
+    // --- sortie d'un plugin conservée en mémoire avant débordement sur disque : --output-memory <Mio>
+    QStringList args = qApp->arguments();
+    int opt = args.indexOf(OPT_OUTPUT_MEMORY);
+    if(opt >= 0)
+    {   bool ok = false;
+        int mib = (opt + 1 < args.size() ? args.at(opt + 1).toInt(&ok) : 0);
+        if(ok && mib >= 0)
+        {   PluginOutput::SetMemoryLimit((qint64)mib * 1024 * 1024);
+        }
+        else
+        {   LOG_WARN(QString("Incorrect parameter : '%1' must be followed by a number of MiB !").arg(OPT_OUTPUT_MEMORY));
+        }
+    }
     if(!PluginManager::getInstance().CheckPlugins())
     {   LOG_CRITICAL("Plugins integrity check failed !");
     }
@@ -28,6 +28,7 @@ Calculation * Calculation::FromJson(QObject * parent, const QByteArray &json, QS
                                               doc.object().value(CS_JSON_KEY_CALC_PARAMS).toObject().toVariantMap(),
                                               doc.object().value(CS_JSON_KEY_FRAG_ID).toString(),
                                               parent);
+                calculation->_binHash = doc.object().value(CS_JSON_KEY_BIN_HASH).toString();
 
             }
         }
@@ -74,7 +75,7 @@ void Calculation::Cancel()
 
 void Calculation::Slot_computed(const QByteArray &json)
 {
-    LOG_DEBUG(QString("Computed received json=%1").arg(QString(json)));
+    LOG_DEBUG(QString("Computed received %1 bytes.").arg(json.size()));
 
     QJsonParseError jsonError;
     QJsonDocument doc = QJsonDocument::fromJson(json, &jsonError);
@@ -102,10 +103,23 @@ void Calculation::Slot_crashed(QString error)
     emit sig_crashed();
 }
 
+void Calculation::Slot_updateProgress(int progress)
+{
+    LOG_DEBUG(QString("New progress for %1 : %2").arg(GetId().toString()).arg(progress));
+    emit sig_progressUpdated(progress);
+}
+
+void Calculation::Slot_updateCheckpoint(const QByteArray &checkpoint)
+{
+    LOG_DEBUG(QString("New checkpoint for %1 : %2").arg(GetId().toString()).arg(QString(checkpoint)));
+    emit sig_checkpointUpdated(checkpoint);
+}
+
 Calculation::Calculation(const QString & bin, const QVariantMap &params, const QString id, QObject * parent) :
     AbstractIdentifiable(parent),
     _state(BEING_SPLITTED),
     _bin(bin),
+    _binHash(),
     _params(params),
     _fragments()
 {
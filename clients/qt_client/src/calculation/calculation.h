@@ -56,6 +56,12 @@ public:
      */
     inline QVariantMap GetParams() const { return _params; }
 
+    /**
+     * @brief Empreinte SHA-256 attendue du plugin, vide si le serveur ne l'a pas fournie
+     * @return
+     */
+    inline QString GetBinHash() const { return _binHash; }
+
     /**
      * @brief Retourne le résultat du calcul
      * @return
@@ -104,6 +110,18 @@ public slots:
      */
     void Slot_crashed(QString error);
 
+    /**
+     * @brief Ce slot est appelé quand le plugin annonce son avancement
+     * @param progress avancement entre 0 et 100
+     */
+    void Slot_updateProgress(int progress);
+
+    /**
+     * @brief Ce slot est appelé quand le plugin fournit un point de reprise
+     * @param checkpoint objet JSON des paramètres permettant de reprendre le calcul
+     */
+    void Slot_updateCheckpoint(const QByteArray &checkpoint);
+
 signals:
     /**
      * @brief Ce signal est émis lorsque le calcul doit être annulé
@@ -127,6 +145,18 @@ signals:
      */
     void sig_computed();
 
+    /**
+     * @brief Ce signal est émis lorsque l'avancement du calcul est mis à jour
+     * @param progress avancement entre 0 et 100
+     */
+    void sig_progressUpdated(int progress);
+
+    /**
+     * @brief Ce signal est émis lorsque le plugin fournit un point de reprise
+     * @param checkpoint objet JSON des paramètres permettant de reprendre le calcul
+     */
+    void sig_checkpointUpdated(const QByteArray &checkpoint);
+
     /**
      * @brief Ce signal est émis lorsque le plugin du calcul crash
      */
@@ -140,6 +170,7 @@ private:
     // attributs
     State _state;
     QString _bin;
+    QString _binHash;
     QVariantMap _params;
     QHash<QUuid,Calculation*> _fragments;
     QJsonObject _result;
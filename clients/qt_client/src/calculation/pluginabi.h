@@ -0,0 +1,58 @@
+#ifndef PLUGINABI_H
+#define PLUGINABI_H
+
+/**
+ * Interface binaire (C) des plugins livrés sous forme de bibliothèque partagée (.so) :
+ * la bibliothèque est chargée dans le processus du serveur ou du client, sans processus
+ * ni échange sur les entrées/sorties standard.
+ *
+ * Chaque opération reçoit la même requête JSON que sur l'entrée standard d'un plugin
+ * exécutable et produit le même résultat. Les points d'entrée peuvent être appelés
+ * simultanément depuis plusieurs threads et doivent donc être réentrants.
+ */
+
+#include <stddef.h>
+
+#define CS_PLUGIN_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Retourne la version de l'interface implémentée, qui doit valoir CS_PLUGIN_ABI_VERSION
+ */
+typedef int (*CsPluginAbiVersion)(void);
+
+/**
+ * @brief Point d'entrée d'une opération
+ * @param in
+ *      Requête JSON
+ * @param inSize
+ *      Taille de la requête en octets
+ * @param out
+ *      Résultat de l'opération, ou message d'erreur, alloué par le plugin
+ * @param outSize
+ *      Taille du résultat en octets
+ * @return 0 en cas de succès, comme le code de sortie d'un plugin exécutable
+ */
+typedef int (*CsPluginEntry)(const char * in, size_t inSize, char ** out, size_t * outSize);
+
+/**
+ * @brief Libère un tampon retourné par un point d'entrée
+ */
+typedef void (*CsPluginFree)(char * buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+// symboles exportés par la bibliothèque, seuls les points d'entrée des opérations sont optionnels
+#define CS_PLUGIN_SYM_VERSION   "cs_plugin_abi_version"
+#define CS_PLUGIN_SYM_FREE      "cs_plugin_free"
+#define CS_PLUGIN_SYM_SPLIT     "cs_plugin_split"
+#define CS_PLUGIN_SYM_CALC      "cs_plugin_calc"
+#define CS_PLUGIN_SYM_JOIN      "cs_plugin_join"
+#define CS_PLUGIN_SYM_PARAM     "cs_plugin_get_params"
+
+#endif // PLUGINABI_H
@@ -5,12 +5,21 @@
 #define CS_JSON_KEY_CALC_PARAMS "params"
 #define CS_JSON_KEY_FRAG_ID     "fragment_id"
 #define CS_JSON_KEY_CALC_RESULT "result"
+#define CS_JSON_KEY_BIN_HASH    "bin_hash"
 
 #define CS_OP_SPLIT "split"
 #define CS_OP_JOIN  "join"
 #define CS_OP_CALC  "calc"
+#define CS_OP_BENCH "bench"
+#define CS_OP_PARAM "get_params"
 #define CS_OP_UI    "ui"
 #define CS_EOF      "EOF"
+#define CS_PROGRESS "PROGRESS"
+#define CS_CHECKPOINT "CHECKPOINT"
+#define CS_OP_WORKER    "worker"
+#define CS_WORKER_HELLO "WORKER 1"
+#define CS_WORKER_OK    "OK"
+#define CS_WORKER_KO    "KO"
 #define CS_CRLF     "\n"
 #define CS_FRAGMENT_SEP ';'
 
@@ -5,12 +5,18 @@
 #include "console/consolehandler.h"
 #include "applicationmanager.h"
 #include "src/const.h"
+#include "src/plugins/libraryplugin.h"
 
 
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
 
+    // -- hôte d'un plugin bibliothèque exécuté dans un processus dédié
+    if(argc == 3 && QString(argv[1]) == OPT_PLUGIN_HOST)
+    {   return LibraryPlugin::Host(argv[2]);
+    }
+
     LOGGER_CONFIGURE(LVL_NO_LVL, LOG_FORMAT_DETAILED);
 
     qRegisterMetaType<Command>("Command");
@@ -11,6 +11,9 @@
 #include <QDataStream>
 
 static const unsigned broadcastPort = 45000;
+static const qint64 progressInterval = 2000; // ms minimum entre deux PROGRESS
+static const qint64 checkpointInterval = 10000; // ms minimum entre deux CHECKPOINT
+static const int heartbeatInterval = 15000; // ms entre deux HEARTBEAT pendant un calcul
 
 /// Ce type est celui utilisé pour stocker la commande associée à un message
 typedef quint8  req_t;
@@ -33,6 +36,10 @@ ClientSession::ClientSession() :
     _broadcastTimer.setInterval(2000);
     connect(&_broadcastTimer, &QTimer::timeout, this, &ClientSession::findServer);
 
+    _heartbeatTimer.setInterval(heartbeatInterval);
+    connect(&_heartbeatTimer, &QTimer::timeout, this, &ClientSession::slot_sendHeartbeat);
+    _heartbeatTimer.start();
+
     findServer();
 }
 
@@ -48,6 +55,7 @@ void ClientSession::Slot_abortCalcul()
 
 void ClientSession::slot_disconnect()
 {
+    Slot_stopCalculation();
     _currentState->OnExit();
     _currentState = _disconnectedState;
     _currentState->OnEntry();
@@ -118,29 +126,35 @@ void ClientSession::slot_processReadyRead()
     QDataStream in(_socket);
     in.setVersion(QDataStream::Qt_5_3);
 
-    if(_blockSize == 0)
-    {   if(_socket->bytesAvailable() < (int)(sizeof(msg_size_t)))
-        {   return; // on a pas encore reçu suffisament d'octets pour connaitre la taille du message et la commande
+    // plusieurs messages (les morceaux d'un plugin par exemple) peuvent arriver d'un coup
+    forever
+    {
+        if(_blockSize == 0)
+        {   if(_socket->bytesAvailable() < (int)(sizeof(msg_size_t)))
+            {   return; // on a pas encore reçu suffisament d'octets pour connaitre la taille du message et la commande
+            }
+            // sinon on inscrit la taille du message dans l'attribut de la classe et la commande
+            in >> _blockSize;
+            LOG_DEBUG(QString("block size received : size=%1").arg(_blockSize));
         }
-        // sinon on inscrit la taille du message dans l'attribut de la classe et la commande
-        in >> _blockSize;
-        LOG_DEBUG(QString("block size received : size=%1").arg(_blockSize));
-    }
-
-    if(_socket->bytesAvailable() < _blockSize)
-        return; // on a pas encore reçu tout le message
 
-    // on commence par récupérer la commande
-    req_t req;
-    in >> req;
-    LOG_DEBUG(QString("request received : req=%1").arg(req));
-    // on récupère ensuite le contenu du message que l'on passe au slot de traitement
-    QByteArray content;
-    in >> content;
-    LOG_DEBUG(QString("content received : text=").append(content));
-    slot_processRequest((ReqType)req, content);
-    // on reset les variables commande et block size
-    _blockSize = 0;
+        if(_socket->bytesAvailable() < _blockSize)
+            return; // on a pas encore reçu tout le message
+
+        // on commence par récupérer la commande
+        req_t req;
+        in >> req;
+        LOG_DEBUG(QString("request received : req=%1").arg(req));
+        // on récupère ensuite le contenu du message que l'on passe au slot de traitement
+        QByteArray content;
+        in >> content;
+        if(req != BIN)
+        {   LOG_DEBUG(QString("content received : %1 bytes").arg(content.size()));
+        }
+        // on reset les variables commande et block size
+        _blockSize = 0;
+        slot_processRequest((ReqType)req, content);
+    }
 }
 
 void ClientSession::readBroadcastDatagram()
@@ -177,9 +191,11 @@ void ClientSession::readBroadcastDatagram()
 
 void ClientSession::Send(ReqType reqType, const QString &content)
 {
-    LOG_DEBUG(QString("Send(reqType='%1',content='%2') called").arg((int)reqType).arg(content));
+    // le contenu n'est converti qu'une fois, et seule sa taille est journalisée
+    QByteArray data = content.toUtf8();
+    LOG_DEBUG(QString("Send(reqType='%1', %2 bytes) called").arg((int)reqType).arg(data.size()));
     // vérification de la taille du contenu à envoyer en octets
-    if( (content.toUtf8().size()+sizeof(req_t)) > MSG_SIZE_MAX)
+    if( (data.size()+sizeof(req_t)) > MSG_SIZE_MAX)
     {   LOG_ERROR("Message content too long to be sent !");
         return;
     }
@@ -190,11 +206,11 @@ void ClientSession::Send(ReqType reqType, const QString &content)
 
     out << (msg_size_t)0;                                   // on reserve sizeof(msg_size_t) pour stocker la taille du message
     out << (req_t)reqType;                                  // on écrit dans le champs requete
-    out << content.toUtf8();                                // on écrit le contenu après la requete
+    out << data;                                            // on écrit le contenu après la requete
     out.device()->seek(0);                                  // on déplace la tête d'écriture au début
     out << (msg_size_t)(block.size() - (int)sizeof(msg_size_t)); // on écrit la taille du message (commande comprise)
 
-    LOG_DEBUG(QString("writing block into socket : block=").append(block.toHex()));
+    LOG_DEBUG(QString("writing block into socket : %1 bytes").arg(block.size()));
 
     _socket->write(block);  // on écrit le bloc dans le socket
     _socket->flush();       // on flush le socket
@@ -205,16 +221,33 @@ void ClientSession::Slot_startCalculation(Calculation *calculation)
     if (_currentCalculation != NULL)
     {
         LOG_DEBUG("Un calcul est déjà en cours");
+        calculation->deleteLater();
         return;
     }
     _currentCalculation = calculation;
     connect(_currentCalculation, &Calculation::sig_computed, this, &ClientSession::Slot_sendResultToServer);
+    connect(_currentCalculation, &Calculation::sig_progressUpdated, this, &ClientSession::Slot_sendProgressToServer);
+    connect(_currentCalculation, &Calculation::sig_checkpointUpdated, this, &ClientSession::Slot_sendCheckpointToServer);
+    _progressTimer.start();
+    _checkpointTimer.start();
     connect(_currentCalculation, &Calculation::sig_canceled, this, &ClientSession::Slot_abortCalcul);
     connect(_currentCalculation, &Calculation::sig_crashed, this, &ClientSession::Slot_abortCalcul);
 
     emit sig_requestCalculStart(calculation);
 }
 
+void ClientSession::Slot_stopCalculation()
+{
+    if (_currentCalculation == NULL)
+        return;
+    // le plugin tué termine le calcul en erreur, c'est à ce moment qu'il peut être supprimé
+    disconnect(_currentCalculation, 0, this, 0);
+    connect(_currentCalculation, &Calculation::sig_computed, _currentCalculation, &QObject::deleteLater);
+    connect(_currentCalculation, &Calculation::sig_crashed, _currentCalculation, &QObject::deleteLater);
+    _currentCalculation = NULL;
+    emit sig_requestCalculStop();
+}
+
 void ClientSession::SetCurrentState()
 {
     QMap<QObject *, AbstractState *>::const_iterator it = _transitionsMap.find(_currentState);
@@ -231,6 +264,29 @@ void ClientSession::setId(const QString &id)
     _id = id;
 }
 
+void ClientSession::Slot_sendProgressToServer(int progress)
+{
+    if (_currentCalculation == NULL || _progressTimer.elapsed() < progressInterval)
+        return;
+    _progressTimer.restart();
+    _currentState->ProcessProgress(progress);
+}
+
+void ClientSession::Slot_sendCheckpointToServer(const QByteArray &checkpoint)
+{
+    if (_currentCalculation == NULL || _checkpointTimer.elapsed() < checkpointInterval)
+        return;
+    _checkpointTimer.restart();
+    _currentState->ProcessCheckpoint(checkpoint);
+}
+
+void ClientSession::slot_sendHeartbeat()
+{
+    if (_currentCalculation == NULL)
+        return;
+    _currentState->ProcessHeartbeat();
+}
+
 void ClientSession::Slot_sendResultToServer()
 {
     if (_currentCalculation == NULL)
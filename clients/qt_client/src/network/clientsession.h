@@ -5,6 +5,7 @@
 #include <QUdpSocket>
 #include <QThread>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QJsonObject>
 #include "src/network/etat/abstractstate.h"
 #include "src/plugins/pluginprocess.h"
@@ -77,11 +78,29 @@ public slots:
      */
     void Slot_sendResultToServer();
 
+    /**
+     * @brief Transmet l'avancement du calcul au serveur, au plus une fois par intervalle
+     * @param progress avancement entre 0 et 100 annoncé par le plugin
+     */
+    void Slot_sendProgressToServer(int progress);
+
+    /**
+     * @brief Transmet un point de reprise du calcul au serveur, au plus une fois par intervalle
+     * @param checkpoint objet JSON fourni par le plugin
+     */
+    void Slot_sendCheckpointToServer(const QByteArray &checkpoint);
+
     /**
      * @brief Démarre le calcul donné si aucun n'est déjà en cours
      */
     void Slot_startCalculation(Calculation *calculation);
 
+    /**
+     * @brief Arrête le plugin du calcul en cours et l'oublie : le calcul est supprimé quand
+     *        son plugin s'est terminé, son résultat n'est plus transmis
+     */
+    void Slot_stopCalculation();
+
 signals:
     /**
      * @brief Emis pour demander au thread de commencer le calcul
@@ -113,7 +132,8 @@ private:
 private slots:
 
     /**
-     * @brief Passe l'automate en mode déconnecté
+     * @brief Passe l'automate en mode déconnecté, le calcul en cours n'est plus attendu par
+     *        le serveur et il est arrêté
      */
     void slot_disconnect();
 
@@ -129,13 +149,22 @@ private slots:
      */
     void slot_processReadyRead();
 
+    /**
+     * @brief Signale au serveur que le client est toujours connecté pendant un calcul, sans
+     *        renouveler le bail du fragment
+     */
+    void slot_sendHeartbeat();
+
 private:
     QTimer _broadcastTimer;
+    QTimer _heartbeatTimer;
     QUdpSocket *_broadcastSocket;
     Calculation *_currentCalculation;
     AbstractState *_currentState;
     AbstractState *_disconnectedState;
     int _fragmentId;
+    QElapsedTimer _progressTimer;
+    QElapsedTimer _checkpointTimer;
     QString _id;
     QTcpSocket *_socket;
     QMap<QObject *, AbstractState *> _transitionsMap;
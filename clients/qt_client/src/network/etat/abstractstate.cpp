@@ -35,11 +35,25 @@ void AbstractState::ProcessBin(const QByteArray &content)
     Q_UNUSED(content)
 }
 
+void AbstractState::ProcessCheckpoint(const QByteArray &checkpoint)
+{
+    Q_UNUSED(checkpoint)
+}
+
 void AbstractState::ProcessDone(const QJsonObject &args)
 {
     Q_UNUSED(args)
 }
 
+void AbstractState::ProcessProgress(int progress)
+{
+    Q_UNUSED(progress)
+}
+
+void AbstractState::ProcessHeartbeat()
+{
+}
+
 void AbstractState::ProcessHello()
 {
 }
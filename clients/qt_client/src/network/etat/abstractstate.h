@@ -51,11 +51,26 @@ public:
      */
     virtual void ProcessBin(const QByteArray &content);
 
+    /**
+     * @brief Effectue la commande CHECKPOINT
+     */
+    virtual void ProcessCheckpoint(const QByteArray &checkpoint);
+
     /**
      * @brief Effectue la commande DONE
      */
     virtual void ProcessDone(const QJsonObject &args);
 
+    /**
+     * @brief Effectue la commande PROGRESS
+     */
+    virtual void ProcessProgress(int progress);
+
+    /**
+     * @brief Effectue la commande HEARTBEAT
+     */
+    virtual void ProcessHeartbeat();
+
     /**
      * @brief Effectue la commande OK
      */
@@ -3,12 +3,14 @@
 #include "src/plugins/pluginmanager.h"
 #include "src/utils/logger.h"
 
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
 
 ReadyState::ReadyState(ClientSession *parent) :
     AbstractState(parent),
-    _calc_todo(NULL)
+    _calc_todo(NULL),
+    _download()
 {
 
 }
@@ -21,6 +23,9 @@ void ReadyState::ProcessDo(const QByteArray &content)
 {
     if (content.size() > 0)
     {
+        // -- un nouveau calcul annule le téléchargement du plugin précédent
+        _download.Abort();
+        delete _calc_todo;
         QString error;
         _calc_todo = Calculation::FromJson(_client, content, error);
 
@@ -30,14 +35,17 @@ void ReadyState::ProcessDo(const QByteArray &content)
             return;
         }
 
-        //TODO: Vérifier que le calcul est faisable et renvoyer UNABLE s'il ne l'est pas
-        if(!PluginManager::getInstance().PluginExists(_calc_todo->GetBin()))
+        // -- le plugin n'est demandé que s'il manque ou si son contenu diffère de celui du serveur
+        if(!PluginManager::getInstance().PluginUpToDate(_calc_todo->GetBin(), _calc_todo->GetBinHash()))
         {
             LOG_DEBUG("Sending UNABLE with id and arch");
             QJsonObject object;
             object.insert("id", _client->Id());
             object.insert("arch", QHOST_ARCH);
             object.insert("os", QHOST_OS);
+            // le plugin peut être envoyé par morceaux compressés
+            object.insert(BIN_KEY_CHUNKED, true);
+            object.insert(BIN_KEY_ENCODINGS, QJsonArray() << QString(BIN_ENCODING_QCOMPRESS));
             _client->Send(UNABLE, QJsonDocument(object).toJson());
             // on ne change pas d'état, c'est le même état qui s'occupe de la reception du plugin
         }
@@ -56,7 +64,21 @@ void ReadyState::ProcessBin(const QByteArray &content)
 {
     if(content.size() > 0 && _calc_todo != NULL)
     {
-        if(PluginManager::getInstance().WritePlugin(_calc_todo->GetBin(), content))
+        PluginManager & manager = PluginManager::getInstance();
+        QString error;
+        bool last = false;
+        // -- chaque morceau est écrit dès sa réception dans un fichier temporaire
+        if(!_download.IsStarted() && !_download.Start(manager.DownloadPath(_calc_todo->GetBin())))
+        {
+            error = "Can't create plugin file.";
+        }
+        else if(_download.Append(content, last, error) && !last)
+        {
+            return; // on attend les morceaux suivants
+        }
+        // -- le plugin n'est installé que si son contenu correspond à l'empreinte annoncée
+        if(error.isEmpty() && _download.Finish(_calc_todo->GetBinHash(), error) &&
+           manager.InstallPlugin(_calc_todo->GetBin(), _download.GetPath()))
         {
             _client->Send(WORKING, _client->Id());
             _client->SetCurrentState();
@@ -64,6 +86,10 @@ void ReadyState::ProcessBin(const QByteArray &content)
         }
         else
         {
+            if(!error.isEmpty())
+            {   LOG_ERROR(QString("Plugin '%1' : %2").arg(_calc_todo->GetBin()).arg(error));
+            }
+            _download.Abort();
             delete _calc_todo;
         }
         _calc_todo = NULL; // this is really dirty but it's a proof of concept work so...
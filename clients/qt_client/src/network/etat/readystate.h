@@ -3,6 +3,7 @@
 
 #include "abstractstate.h"
 #include "src/calculation/calculation.h"
+#include "src/plugins/plugindownload.h"
 
 /**
  * @brief Etat prêt
@@ -35,6 +36,7 @@ public:
 
 private:
     Calculation * _calc_todo;
+    PluginDownload _download;
 
 };
 
@@ -17,6 +17,11 @@ void WorkingState::ProcessAbort()
     _client->SetCurrentState();
 }
 
+void WorkingState::ProcessCheckpoint(const QByteArray &checkpoint)
+{
+    _client->Send(CHECKPOINT, _client->Id() + QString::fromUtf8(checkpoint));
+}
+
 void WorkingState::ProcessDone(const QJsonObject &args)
 {
     QJsonDocument doc(args);
@@ -24,8 +29,18 @@ void WorkingState::ProcessDone(const QJsonObject &args)
     _client->SetCurrentState();
 }
 
+void WorkingState::ProcessProgress(int progress)
+{
+    _client->Send(PROGRESS, _client->Id() + QString::number(progress));
+}
+
+void WorkingState::ProcessHeartbeat()
+{
+    _client->Send(HEARTBEAT, _client->Id());
+}
+
 void WorkingState::ProcessStop()
 {
-    emit _client->sig_requestCalculStop();
+    _client->Slot_stopCalculation();
     _client->SetCurrentState();
 }
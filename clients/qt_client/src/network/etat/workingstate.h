@@ -27,11 +27,26 @@ public:
      */
     virtual void ProcessAbort() override;
 
+    /**
+     * @brief Effectue la commande CHECKPOINT
+     */
+    virtual void ProcessCheckpoint(const QByteArray &checkpoint) override;
+
     /**
      * @brief Effectue la commande DONE
      */
     virtual void ProcessDone(const QJsonObject &args) override;
 
+    /**
+     * @brief Effectue la commande PROGRESS
+     */
+    virtual void ProcessProgress(int progress) override;
+
+    /**
+     * @brief Effectue la commande HEARTBEAT
+     */
+    virtual void ProcessHeartbeat() override;
+
     /**
      * @brief Effectue la commande STOP
      */
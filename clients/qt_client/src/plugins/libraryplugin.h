@@ -0,0 +1,63 @@
+#ifndef LIBRARYPLUGIN_H
+#define LIBRARYPLUGIN_H
+
+#include "src/calculation/pluginabi.h"
+#include <QLibrary>
+#include <QHash>
+
+#define OPT_PLUGIN_HOST "--plugin-host"
+
+/**
+ * @brief Cette classe représente un plugin livré sous forme de bibliothèque partagée, chargé
+ *      dans le processus courant
+ * @see pluginabi.h
+ */
+class LibraryPlugin
+{
+public:
+    /**
+     * @brief Charge la bibliothèque et résout ses points d'entrée
+     * @param path
+     *      Chemin absolu de la bibliothèque
+     * @param error
+     *      Message d'erreur si le chargement échoue
+     * @return NULL si la bibliothèque n'a pas pu être chargée ou n'implémente pas l'interface
+     */
+    static LibraryPlugin * Load(const QString & path, QString & error);
+    ~LibraryPlugin(){} // la bibliothèque reste chargée, des appels peuvent être en cours
+    /**
+     * @brief Appelle le point d'entrée d'une opération, depuis n'importe quel thread
+     * @param op
+     *      Nom de l'opération (split, calc, join, get_params)
+     * @param in
+     *      Requête JSON
+     * @param out
+     *      Résultat de l'opération ou message d'erreur
+     * @return vrai si l'opération a réussi
+     */
+    bool Call(const QByteArray & op, const QByteArray & in, QByteArray & out) const;
+    /**
+     * @brief Décharge la bibliothèque pour qu'une nouvelle version puisse être chargée
+     * @warning aucun appel ne doit être en cours
+     */
+    inline void Unload() { _library.unload(); }
+    /**
+     * @brief Exécute une opération de la bibliothèque à la manière d'un plugin exécutable :
+     *      requête sur l'entrée standard, résultat sur la sortie standard. Un plugin lancé
+     *      ainsi dans un processus dédié ne peut pas faire tomber l'application
+     * @param path
+     *      Chemin absolu de la bibliothèque
+     * @return code de sortie du processus
+     */
+    static int Host(const QString & path);
+
+private:
+    LibraryPlugin(const QString & path);
+    Q_DISABLE_COPY(LibraryPlugin)
+
+    QLibrary _library;
+    CsPluginFree _free;
+    QHash<QByteArray, CsPluginEntry> _entries;
+};
+
+#endif // LIBRARYPLUGIN_H
@@ -0,0 +1,19 @@
+#include "librarytask.h"
+
+LibraryTask::LibraryTask(const LibraryPlugin *plugin, const QByteArray &op, const QByteArray &in, QObject *parent) :
+    QObject(parent),
+    _plugin(plugin),
+    _op(op),
+    _in(in),
+    _out(),
+    _ok(false)
+{
+    // le propriétaire supprime la tâche après avoir lu son résultat
+    setAutoDelete(false);
+}
+
+void LibraryTask::run()
+{
+    _ok = _plugin->Call(_op, _in, _out);
+    emit sig_done();
+}
@@ -0,0 +1,50 @@
+#ifndef LIBRARYTASK_H
+#define LIBRARYTASK_H
+
+#include "libraryplugin.h"
+#include <QObject>
+#include <QRunnable>
+
+/**
+ * @brief Cette classe représente l'appel d'une opération d'un plugin bibliothèque, exécuté
+ *      par un pool de threads. La requête est construite avant le lancement, le résultat
+ *      est lu par le propriétaire de la tâche à réception de sig_done()
+ */
+class LibraryTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    LibraryTask(const LibraryPlugin * plugin, const QByteArray & op, const QByteArray & in, QObject * parent = NULL);
+    ~LibraryTask(){}
+    /**
+     * @brief Exécute l'opération, dans un thread du pool
+     */
+    void run();
+    /**
+     * @brief Indique si l'opération a réussi
+     */
+    inline bool IsOk() const { return _ok; }
+    /**
+     * @brief Retourne le résultat de l'opération ou le message d'erreur
+     */
+    inline const QByteArray & GetOutput() const { return _out; }
+    /**
+     * @brief Retourne le plugin appelé
+     */
+    inline const LibraryPlugin * GetPlugin() const { return _plugin; }
+
+signals:
+    /**
+     * @brief Ce signal est émis depuis le thread du pool quand l'opération est terminée
+     */
+    void sig_done();
+
+private:
+    const LibraryPlugin * _plugin;
+    QByteArray _op;
+    QByteArray _in;
+    QByteArray _out;
+    bool _ok;
+};
+
+#endif // LIBRARYTASK_H
@@ -0,0 +1,74 @@
+#include "plugindownload.h"
+#include "src/const.h"
+
+PluginDownload::PluginDownload() :
+    _file(),
+    _hash(QCryptographicHash::Sha256)
+{
+}
+
+PluginDownload::~PluginDownload()
+{
+    Abort();
+}
+
+bool PluginDownload::Start(const QString &path)
+{
+    Abort();
+    _hash.reset();
+    _file.setFileName(path);
+    return _file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+bool PluginDownload::Append(const QByteArray &chunk, bool &last, QString &error)
+{
+    if(!IsStarted())
+    {   error = "No plugin download in progress";
+        return false;
+    }
+    if(chunk.isEmpty())
+    {   error = "Empty plugin chunk received";
+        return false;
+    }
+    quint8 flags = (quint8)chunk.at(0);
+    last = flags & BIN_CHUNK_LAST;
+    // -- le morceau est lu sans copie, puis décompressé s'il y a lieu
+    QByteArray data = QByteArray::fromRawData(chunk.constData() + 1, chunk.size() - 1);
+    if(flags & BIN_CHUNK_COMPRESSED)
+    {   data = qUncompress(data);
+        if(data.isEmpty())
+        {   error = "Can't uncompress plugin chunk";
+            return false;
+        }
+    }
+    _hash.addData(data);
+    if(_file.write(data) != data.size())
+    {   error = QString("Can't write plugin file : %1").arg(_file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool PluginDownload::Finish(const QString &hash, QString &error)
+{
+    _file.close();
+    if(_file.error() != QFileDevice::NoError)
+    {   error = QString("Can't write plugin file : %1").arg(_file.errorString());
+        _file.remove();
+        return false;
+    }
+    if(!hash.isEmpty() && QString(_hash.result().toHex()) != hash)
+    {   error = "Plugin doesn't match expected hash";
+        _file.remove();
+        return false;
+    }
+    return true;
+}
+
+void PluginDownload::Abort()
+{
+    if(IsStarted())
+    {   _file.close();
+        _file.remove();
+    }
+}
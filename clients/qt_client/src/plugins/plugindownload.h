@@ -0,0 +1,67 @@
+#ifndef PLUGINDOWNLOAD_H
+#define PLUGINDOWNLOAD_H
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QFile>
+
+/**
+ * @brief Cette classe reçoit un plugin envoyé par morceaux (commandes BIN) : chaque morceau est
+ *      décompressé puis écrit directement dans un fichier temporaire, l'empreinte du contenu est
+ *      calculée au fil de l'eau. Le plugin n'est jamais entièrement en mémoire
+ */
+class PluginDownload
+{
+public:
+    PluginDownload();
+    /**
+     * @brief Abandonne le téléchargement en cours s'il y en a un
+     */
+    ~PluginDownload();
+    /**
+     * @brief Commence un téléchargement
+     * @param path
+     *      Chemin du fichier temporaire
+     * @return faux si le fichier ne peut pas être créé
+     */
+    bool Start(const QString & path);
+    /**
+     * @brief Ajoute un morceau reçu au fichier
+     * @param chunk
+     *      Contenu de la commande BIN : drapeaux puis morceau
+     * @param last
+     *      Vrai si c'était le dernier morceau
+     * @param error
+     *      Message d'erreur si le morceau est invalide
+     * @return faux si le morceau n'a pas pu être écrit
+     */
+    bool Append(const QByteArray & chunk, bool & last, QString & error);
+    /**
+     * @brief Termine le téléchargement et vérifie l'empreinte du contenu reçu
+     * @param hash
+     *      Empreinte SHA-256 attendue en hexadécimal, vide pour ne pas vérifier
+     * @return faux si le fichier n'a pas pu être écrit ou ne correspond pas à l'empreinte, il
+     *      est alors supprimé
+     */
+    bool Finish(const QString & hash, QString & error);
+    /**
+     * @brief Abandonne le téléchargement et supprime le fichier temporaire
+     */
+    void Abort();
+    /**
+     * @brief Indique si un téléchargement est en cours
+     */
+    inline bool IsStarted() const { return _file.isOpen(); }
+    /**
+     * @brief Retourne le chemin du fichier temporaire
+     */
+    inline QString GetPath() const { return _file.fileName(); }
+
+private:
+    Q_DISABLE_COPY(PluginDownload)
+
+    QFile _file;
+    QCryptographicHash _hash;
+};
+
+#endif // PLUGINDOWNLOAD_H
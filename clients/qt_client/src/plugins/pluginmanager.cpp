@@ -4,11 +4,14 @@
 #include "src/calculation/specs.h"
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QFile>
+#include <QFileInfo>
 
 #define ENTRY_LIST_FILTER   QDir::Files
 #define ENTRY_LIST_SORT     QDir::Name
 #define ENTRY_LIST()        _plugins_dir.entryList(ENTRY_LIST_FILTER, ENTRY_LIST_SORT)
+#define WORKER_HELLO_TIMEOUT 5000 // ms
 
 PluginManager PluginManager::_instance;
 
@@ -30,11 +33,13 @@ bool PluginManager::Init()
     return ok;
 }
 
-bool PluginManager::CheckPlugins() const
+bool PluginManager::CheckPlugins()
 {
     bool ok = true;
     foreach (QString plugin, ENTRY_LIST())
-    {   /// \todo do a MD5 checksum
+    {   if(localHash(plugin).isEmpty())
+        {   ok = false;
+        }
     }
     return ok;
 }
@@ -44,6 +49,14 @@ bool PluginManager::PluginExists(const QString &pluginName) const
     return ENTRY_LIST().contains(pluginName);
 }
 
+bool PluginManager::PluginUpToDate(const QString &pluginName, const QString &hash)
+{
+    if(!PluginExists(pluginName))
+    {   return false;
+    }
+    return hash.isEmpty() || localHash(pluginName) == hash;
+}
+
 QStringList PluginManager::GetPluginsList() const
 {
     return ENTRY_LIST();
@@ -59,19 +72,58 @@ void PluginManager::Join(Calculation *calc)
     startProcess(calc, PluginProcess::JOIN);
 }
 
-bool PluginManager::WritePlugin(QString fname, const QByteArray &data)
+QString PluginManager::DownloadPath(const QString &pluginName) const
 {
-    QFile f(fname.prepend('/').prepend(_plugins_dir.absolutePath()));
-    if(!f.open(QIODevice::WriteOnly))
+    return _plugins_dir.absoluteFilePath(QString(".%1.part").arg(pluginName));
+}
+
+bool PluginManager::InstallPlugin(const QString &pluginName, const QString &path)
+{
+    // -- le worker de l'ancienne version du plugin ne doit plus servir
+    dropWorker(pluginName);
+    dropLibrary(pluginName);
+    _oneShotPlugins.remove(pluginName);
+    _hashes.remove(pluginName);
+    QString fname = _plugins_dir.absoluteFilePath(pluginName);
+    // le fichier est remplacé plutôt que réécrit : une bibliothèque encore projetée en mémoire reste valide
+    QFile::remove(fname);
+    if(!QFile::rename(path, fname))
     {
         LOG_ERROR("Can't create plugin file.");
+        QFile::remove(path);
         return false;
     }
-    f.write(data);
-    f.close();
     return true;
 }
 
+QString PluginManager::localHash(const QString &pluginName)
+{
+    QFile f(_plugins_dir.absoluteFilePath(pluginName));
+    QFileInfo info(f);
+    // -- l'empreinte n'est recalculée que si le fichier a changé depuis la dernière fois
+    QHash<QString, LocalHash>::const_iterator it = _hashes.constFind(pluginName);
+    if(it != _hashes.constEnd() && it.value().size == info.size() && it.value().modified == info.lastModified())
+    {   return it.value().hash;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if(!f.open(QIODevice::ReadOnly) || !hash.addData(&f))
+    {   LOG_ERROR(QString("Can't read plugin '%1' !").arg(pluginName));
+        _hashes.remove(pluginName);
+        return QString();
+    }
+    LocalHash entry;
+    entry.size = info.size();
+    entry.modified = info.lastModified();
+    entry.hash = QString(hash.result().toHex());
+    _hashes.insert(pluginName, entry);
+    return entry.hash;
+}
+
+void PluginManager::SetIsolatePlugins(bool isolate)
+{
+    _isolatePlugins = isolate;
+}
+
 void PluginManager::Slot_calc(Calculation *calc)
 {   // -- lancement du processus associé
     startProcess(calc, PluginProcess::CALC);
@@ -79,6 +131,20 @@ void PluginManager::Slot_calc(Calculation *calc)
 
 void PluginManager::startProcess(Calculation * calc, PluginProcess::Operation op)
 {
+    // -- un plugin bibliothèque est appelé dans le processus, sauf s'il doit en être isolé : le
+    //    calcul d'un fragment l'est toujours, un hôte bloqué ou planté peut être tué par un STOP
+    if(!_isolatePlugins && op != PluginProcess::CALC &&
+       PluginProcess::DetectType(calc->GetBin()) == PluginProcess::LIBRARY)
+    {   callLibrary(calc, op);
+        return;
+    }
+    // -- un plugin en mode worker traite la requête sans nouveau processus
+    PluginWorker * pw = (op == PluginProcess::UI ? NULL : worker(calc->GetBin()));
+    if(pw)
+    {   pw->Submit(calc, op);
+        pw->WaitForResponse();
+        return;
+    }
     // -- création d'un nouveau processus
     PluginProcess * cp = new PluginProcess(_plugins_dir.absolutePath(), calc, op);
     // -- ajout du process à la liste
@@ -123,19 +189,168 @@ void PluginManager::startProcess(Calculation * calc, PluginProcess::Operation op
         LOG_CRITICAL("Processus started without arguments : unhandled operation is the cause !");
         break;
     }
-    cp->waitForFinished();
+    // -- le résultat est transmis au calcul par le processus à sa fin
 }
 
 void PluginManager::Slot_stop()
 {
     LOG_DEBUG("Slot_stop() called.");
-    if (_processes.size() > 0 && _processes.first()->state() == QProcess::Running)
-        _processes.first()->kill();
+    // -- les processus terminés restent dans la liste, le calcul en cours n'est pas forcément le premier
+    foreach (PluginProcess * cp, _processes)
+    {   if(cp->state() != QProcess::NotRunning) cp->kill();
+    }
+    // -- un worker occupé est tué, il sera relancé à la prochaine requête
+    foreach (PluginWorker * pw, _workers)
+    {   if(pw->IsBusy()) pw->kill();
+    }
+}
+
+void PluginManager::callLibrary(Calculation *calc, PluginProcess::Operation op)
+{
+    LibraryPlugin * plugin = _libraries.value(calc->GetBin(), NULL);
+    if(!plugin)
+    {   QString error;
+        plugin = LibraryPlugin::Load(_plugins_dir.absoluteFilePath(calc->GetBin()), error);
+        if(!plugin)
+        {   calc->Slot_crashed(error);
+            return;
+        }
+        _libraries.insert(calc->GetBin(), plugin);
+    }
+    // -- construction de la requête
+    QByteArray json;
+    const char * name = NULL;
+    switch (op) {
+    case PluginProcess::SPLIT: // utile côté serveur
+        name = CS_OP_SPLIT;
+        json = calc->ToJson().toUtf8();
+        break;
+    case PluginProcess::JOIN: // utile côté serveur
+        name = CS_OP_JOIN;
+        json = calc->FragmentsToJson().toUtf8();
+        break;
+    case PluginProcess::CALC: // utile côté client
+        name = CS_OP_CALC;
+        json = calc->ToJson().toUtf8();
+        break;
+    default:
+        LOG_CRITICAL("Library call without arguments : unhandled operation is the cause !");
+        return;
+    }
+    // -- appel dans le pool, la boucle d'évènements du client continue pendant l'appel
+    LibraryTask * task = new LibraryTask(plugin, name, json);
+    connect(task, SIGNAL(sig_done()), SLOT(slot_libraryDone()), Qt::QueuedConnection);
+    _libraryTasks.insert(task, calc);
+    _libraryPool.start(task);
+}
+
+void PluginManager::slot_libraryDone()
+{
+    LibraryTask * task = qobject_cast<LibraryTask*>(sender());
+    if(!task || !_libraryTasks.contains(task)) return;
+    Calculation * calc = _libraryTasks.take(task);
+    if(!task->IsOk())
+    {   calc->Slot_crashed(task->GetOutput());
+    }
+    else
+    {   // -- les lignes d'avancement et de reprise sont retirées du résultat
+        QByteArray out;
+        QList<QByteArray> lines = task->GetOutput().split('\n');
+        for(int i = 0; i < lines.size(); ++i)
+        {   if(!PluginProcess::ReadSideChannel(calc, lines.at(i)))
+            {   out.append(lines.at(i));
+                if(i < lines.size() - 1) out.append('\n');
+            }
+        }
+        calc->Slot_computed(QByteArray::fromPercentEncoding(out));
+    }
+    LibraryPlugin * plugin = const_cast<LibraryPlugin*>(task->GetPlugin());
+    if(_retiredLibraries.contains(plugin))
+    {   retireLibrary(plugin);
+    }
+    task->deleteLater();
+}
+
+void PluginManager::dropLibrary(const QString &bin)
+{
+    LibraryPlugin * plugin = _libraries.take(bin);
+    if(plugin)
+    {   retireLibrary(plugin);
+    }
+}
+
+void PluginManager::retireLibrary(LibraryPlugin *plugin)
+{
+    foreach (LibraryTask * task, _libraryTasks.keys())
+    {   if(task->GetPlugin() == plugin)
+        {   _retiredLibraries.insert(plugin);
+            return;
+        }
+    }
+    _retiredLibraries.remove(plugin);
+    plugin->Unload();
+    delete plugin;
+}
+
+PluginWorker * PluginManager::worker(const QString &bin)
+{
+    // -- l'hôte d'un plugin bibliothèque ne traite qu'une opération
+    if(_oneShotPlugins.contains(bin) || PluginProcess::DetectType(bin) == PluginProcess::LIBRARY)
+    {   return NULL;
+    }
+    PluginWorker * pw = _workers.value(bin, NULL);
+    if(pw && pw->state() == QProcess::Running)
+    {   return pw->IsBusy() ? NULL : pw;
+    }
+    // -- premier appel ou worker mort : (re)démarrage
+    if(pw)
+    {   _workers.remove(bin);
+        pw->deleteLater();
+    }
+    QString command;
+    if(!PluginProcess::WorkerCommand(_plugins_dir.absolutePath(), bin, command))
+    {   return NULL;
+    }
+    pw = new PluginWorker(this);
+    if(!pw->Start(command, WORKER_HELLO_TIMEOUT))
+    {   LOG_INFO(QString("Plugin '%1' doesn't support worker mode, one process per operation will be used.").arg(bin));
+        pw->kill();
+        pw->waitForFinished();
+        delete pw;
+        _oneShotPlugins.insert(bin);
+        return NULL;
+    }
+    LOG_INFO(QString("Plugin '%1' started in worker mode.").arg(bin));
+    _workers.insert(bin, pw);
+    return pw;
+}
+
+void PluginManager::dropWorker(const QString &bin)
+{
+    PluginWorker * pw = _workers.take(bin);
+    if(pw)
+    {   pw->Close();
+        pw->deleteLater();
+    }
 }
 
 
 void PluginManager::Slot_terminate()
 {   LOG_DEBUG("Slot_terminate() called.");
+    // -- stop all plugin workers
+    foreach (PluginWorker * pw, _workers)
+    {   pw->Close();
+        delete pw;
+    }
+    _workers.clear();
+    // -- release plugin libraries once pending calls are over
+    _libraryPool.waitForDone();
+    qDeleteAll(_libraryTasks.keys());
+    _libraryTasks.clear();
+    qDeleteAll(_libraries);
+    _libraries.clear();
+    qDeleteAll(_retiredLibraries);
+    _retiredLibraries.clear();
     // -- kill all pending processes
     while(!_processes.isEmpty())
     {   PluginProcess * cp = _processes.takeFirst();
@@ -150,6 +365,14 @@ void PluginManager::Slot_terminate()
 
 PluginManager::PluginManager() :
     _plugins_dir(),
-    _processes()
+    _processes(),
+    _workers(),
+    _oneShotPlugins(),
+    _libraryPool(),
+    _libraries(),
+    _libraryTasks(),
+    _retiredLibraries(),
+    _hashes(),
+    _isolatePlugins(false)
 {
 }
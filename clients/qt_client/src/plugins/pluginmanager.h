@@ -2,8 +2,14 @@
 #define PLUGINMANAGER_H
 
 #include "pluginprocess.h"
+#include "pluginworker.h"
+#include "librarytask.h"
 #include <QStringList>
+#include <QDateTime>
 #include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
 
 /**
  * @brief Cette classe gère les interactions avec les plugins
@@ -17,10 +23,12 @@ public:
      */
     bool Init();
     /**
-     * @brief Vérification de l'intégrité des plugins
-     * @return
+     * @brief Vérification de l'intégrité des plugins : chaque plugin doit pouvoir être lu, son
+     *      empreinte est calculée au passage et sera comparée à celle du serveur sans relire
+     *      le fichier
+     * @return faux si un plugin ne peut pas être lu
      */
-    bool CheckPlugins() const;
+    bool CheckPlugins();
     /**
      * @brief Vérification de l'existence d'un plugin
      * @param plugin_name
@@ -28,6 +36,14 @@ public:
      * @return
      */
     bool PluginExists(const QString & pluginName) const;
+    /**
+     * @brief Vérifie que le plugin local correspond à la version attendue par le serveur
+     * @param hash
+     *      Empreinte SHA-256 attendue, en hexadécimal ; vide si le serveur ne la fournit pas,
+     *      seule l'existence du plugin est alors vérifiée
+     * @return
+     */
+    bool PluginUpToDate(const QString & pluginName, const QString & hash);
     /**
      * @brief Récupération de la liste des plugins
      * @return
@@ -44,18 +60,75 @@ public:
      */
     void Join(Calculation * calc);
     /**
-     * @brief Retourne l'architecture de la machine
+     * @brief Retourne le chemin du fichier temporaire dans lequel un plugin est téléchargé,
+     *      caché pour ne pas être pris pour un plugin
+     * @return
+     */
+    QString DownloadPath(const QString & pluginName) const;
+    /**
+     * @brief Installe un plugin téléchargé à la place de l'éventuelle version précédente
+     * @param path
+     *      Fichier temporaire contenant le plugin
      * @return
      */
-    bool WritePlugin(QString fname, const QByteArray & data);
+    bool InstallPlugin(const QString & pluginName, const QString & path);
+    /**
+     * @brief Exécute toutes les opérations des plugins bibliothèque dans un processus hôte
+     *      dédié plutôt que dans le client, le calcul d'un fragment l'est toujours : plus lent,
+     *      mais un plugin qui plante ne fait pas tomber le client
+     * @param isolate
+     */
+    void SetIsolatePlugins(bool isolate);
 
 private:
+    /**
+     * @brief Empreinte d'un plugin local, valable tant que sa taille et sa date ne changent pas
+     */
+    struct LocalHash {
+        qint64 size;
+        QDateTime modified;
+        QString hash;
+    };
+    /**
+     * @brief Retourne l'empreinte d'un plugin local, calculée seulement si le fichier a changé
+     * @return vide si le plugin ne peut pas être lu
+     */
+    QString localHash(const QString & pluginName);
     /**
      * @brief Démarre un nouveau processus pour un calcul
      * @param program
      * @param args
      */
     void startProcess(Calculation * calc, PluginProcess::Operation op);
+    /**
+     * @brief Retourne le worker persistant du plugin, démarré au premier appel
+     * @return NULL si le plugin ne supporte pas le mode worker ou si son worker est occupé
+     */
+    PluginWorker * worker(const QString & bin);
+    /**
+     * @brief Arrête le worker du plugin, par exemple quand son binaire est remplacé
+     */
+    void dropWorker(const QString & bin);
+    /**
+     * @brief Appelle l'opération d'un plugin bibliothèque dans le pool de threads, le résultat
+     *      est transmis au calcul par slot_libraryDone(), la bibliothèque est chargée au
+     *      premier appel
+     */
+    void callLibrary(Calculation * calc, PluginProcess::Operation op);
+    /**
+     * @brief Décharge le plugin bibliothèque, par exemple quand son fichier est remplacé
+     */
+    void dropLibrary(const QString & bin);
+    /**
+     * @brief Décharge une bibliothèque remplacée, ou la conserve jusqu'à la fin de ses appels
+     */
+    void retireLibrary(LibraryPlugin * plugin);
+
+private slots:
+    /**
+     * @brief Ce slot transmet au calcul le résultat d'un appel de plugin bibliothèque
+     */
+    void slot_libraryDone();
 
 signals:
     /**
@@ -97,6 +170,14 @@ private: // singleton
 
     QDir _plugins_dir;
     PluginProcessList _processes;
+    QHash<QString, PluginWorker*> _workers;
+    QSet<QString> _oneShotPlugins;
+    QThreadPool _libraryPool;
+    QHash<QString, LibraryPlugin*> _libraries;
+    QHash<LibraryTask*, Calculation*> _libraryTasks;
+    QSet<LibraryPlugin*> _retiredLibraries;
+    QHash<QString, LocalHash> _hashes;
+    bool _isolatePlugins;
 };
 
 #endif // PLUGINMANAGER_H
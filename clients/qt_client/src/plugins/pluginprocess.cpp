@@ -2,49 +2,71 @@
 #include "src/calculation/specs.h"
 #include "src/utils/logger.h"
 
-#include <QUrl>
+#include "libraryplugin.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QLibrary>
+
+#define ERROR_TAIL_SIZE (64 * 1024) // octets de la sortie d'erreur conservés
 
 PluginProcess::PluginProcess(QString absExecDir, Calculation *calc, Operation op, QObject *parent) :
     QProcess(parent),
     _absExecDir(absExecDir),
     _calculation(calc),
     _op(op),
-    _out(""),
-    _err("")
+    _output(true),
+    _midLine(false),
+    _err()
 {
     // -- connexion du calcul aux évènements du processus
     connect(this, SIGNAL(error(QProcess::ProcessError)),      SLOT(SLOT_ERROR(QProcess::ProcessError)));
     connect(this, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(SLOT_FINISHED(int,QProcess::ExitStatus)));
+    connect(this, SIGNAL(readyReadStandardOutput()),          SLOT(SLOT_READ_OUTPUT()));
+    connect(this, SIGNAL(readyReadStandardError()),           SLOT(slot_readError()));
 }
 
 bool PluginProcess::Start()
+{
+    QString command;
+    bool ok = Command(_absExecDir, _calculation->GetBin(), command);
+    // -- démarrage du plugin
+    if(ok)
+    {   start(command);
+    }
+    // -- retour du statut
+    return ok;
+}
+
+bool PluginProcess::Command(const QString & absExecDir, const QString & bin, QString & command)
 {
     // construction de la commande en fonction du type de binaire
-    QString command(_absExecDir);
+    command = absExecDir;
     // on ajoute le nom du binaire à la fin
-    command.append('/').append(_calculation->GetBin());
+    command.append('/').append(bin);
     // en fonction du type on effectue des opérations supplémentaires
     bool ok = true;
-    switch (detectType()) {
+    switch (DetectType(bin)) {
     case BINARY: break;
     case JAR:
         command.prepend("java -jar ");
         break;
     case SCRIPT:
-        if(! selectInterpreter().isNull() )
-        {   command.prepend(selectInterpreter()).prepend(" ");
+        if(! selectInterpreter(bin).isNull() )
+        {   command.prepend(" ").prepend(selectInterpreter(bin));
         }
         else
         {   ok = false;
         }
         break;
+    case LIBRARY:
+        // la bibliothèque est chargée par une autre instance de l'application
+        command.prepend(" " OPT_PLUGIN_HOST " ").prepend(qApp->applicationFilePath());
+        break;
     }
-    // -- démarrage du plugin
-    if(ok)
-    {   // on exécute la commande trimmée pour éviter les espaces traitres
-        start(command.trimmed());
-    }
-    // -- retour du statut
+    // on trimme la commande pour éviter les espaces traitres
+    command = command.trimmed();
     return ok;
 }
 
@@ -80,30 +102,97 @@ void PluginProcess::SLOT_FINISHED(int exitCode, QProcess::ExitStatus exitStatus)
     case QProcess::NormalExit:
         if(exitCode == 0)
         {
-            _calculation->Slot_computed(QUrl::fromPercentEncoding(readAllStandardOutput()).toUtf8());
+            SLOT_READ_OUTPUT();
+            _output.Append(readAllStandardOutput()); // dernière ligne sans fin de ligne
+            bool ok;
+            QByteArray out = _output.Finish(ok);
+            if(ok)
+            {   _calculation->Slot_computed(out);
+            }
+            else
+            {   _calculation->Slot_crashed("can't store plugin output.");
+            }
         }
         else
         {   LOG_ERROR(QString("Process crashed (exit_code=%1).").arg(exitCode));
             // crash calculation
-            _calculation->Slot_crashed(readAllStandardError());
+            slot_readError();
+            _calculation->Slot_crashed(_err);
         }
         break;
     case QProcess::CrashExit:
         LOG_ERROR(QString("Process crashed (exit_code=%1).").arg(exitCode));
         // crash calculation
-        _calculation->Slot_crashed(readAllStandardError());
+        slot_readError();
+        _calculation->Slot_crashed(_err);
         break;
     }
 }
 
+void PluginProcess::SLOT_READ_OUTPUT()
+{
+    while(canReadLine())
+    {   QByteArray line = readLine();
+        // -- une ligne commencée dans le résultat n'est pas une ligne d'avancement ou de reprise
+        if(_midLine || !ReadSideChannel(_calculation, line))
+        {   _output.Append(line);
+        }
+        _midLine = false;
+    }
+    // -- une ligne incomplète qui ne peut pas être une ligne d'avancement ou de reprise fait
+    //    partie du résultat : elle est consommée sans attendre sa fin
+    QByteArray head = peek(sizeof(CS_CHECKPOINT));
+    if(head.isEmpty() || (!_midLine && (QByteArray(CS_PROGRESS " ").startsWith(head.left(sizeof(CS_PROGRESS))) ||
+                                        QByteArray(CS_CHECKPOINT " ").startsWith(head))))
+    {   return;
+    }
+    _output.Append(readAll());
+    _midLine = true;
+}
+
+void PluginProcess::slot_readError()
+{
+    _err.append(readAllStandardError());
+    if(_err.size() > ERROR_TAIL_SIZE)
+    {   _err = _err.right(ERROR_TAIL_SIZE);
+    }
+}
+
+bool PluginProcess::ReadSideChannel(Calculation *calc, const QByteArray &line)
+{
+    if(line.startsWith(CS_PROGRESS " "))
+    {   bool ok;
+        int progress = line.mid(sizeof(CS_PROGRESS)).trimmed().toInt(&ok);
+        if(ok) calc->Slot_updateProgress(qBound(0, progress, 100));
+        return true;
+    }
+    if(line.startsWith(CS_CHECKPOINT " "))
+    {   calc->Slot_updateCheckpoint(line.mid(sizeof(CS_CHECKPOINT)).trimmed());
+        return true;
+    }
+    return false;
+}
+
 #define JAR_EXT "jar"
+#define JAR_HOST_FILE "ptrs-jarhost.jar"
 #define SCRIPT_EXT() QStringList({"py","sh"})
 #define SCRIPT_INTERPRETER() QStringList({"python", "bash"})
 
-PluginProcess::Type PluginProcess::detectType()
+bool PluginProcess::WorkerCommand(const QString &absExecDir, const QString &bin, QString &command)
+{
+    // -- l'hôte JVM charge le plugin et reçoit ses opérations selon le protocole worker
+    QString host = QDir(qApp->applicationDirPath()).absoluteFilePath(JAR_HOST_FILE);
+    if(DetectType(bin) == JAR && QFile::exists(host))
+    {   command = QString("java -jar %1 %2/%3").arg(host).arg(absExecDir).arg(bin);
+        return true;
+    }
+    return Command(absExecDir, bin, command);
+}
+
+PluginProcess::Type PluginProcess::DetectType(const QString & bin)
 {
     Type type = BINARY;
-    QStringList parts = _calculation->GetBin().split('.', QString::SkipEmptyParts);
+    QStringList parts = bin.split('.', QString::SkipEmptyParts);
     if(!parts.isEmpty())
     {   if(parts.last() == JAR_EXT)
         {   type = JAR;
@@ -111,13 +200,16 @@ PluginProcess::Type PluginProcess::detectType()
         else if(SCRIPT_EXT().contains(parts.last()))
         {   type = SCRIPT;
         }
+        else if(QLibrary::isLibrary(bin))
+        {   type = LIBRARY;
+        }
     }
     return type;
 }
 
-QString PluginProcess::selectInterpreter()
+QString PluginProcess::selectInterpreter(const QString & bin)
 {
-    QStringList parts = _calculation->GetBin().split('.', QString::SkipEmptyParts);
+    QStringList parts = bin.split('.', QString::SkipEmptyParts);
     int index(-1);
     if(!parts.isEmpty())
     {   index = SCRIPT_EXT().indexOf(parts.last());
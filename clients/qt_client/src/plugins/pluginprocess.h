@@ -2,6 +2,7 @@
 #define PluginProcess_H
 
 #include "src/calculation/calculation.h"
+#include "pluginoutput.h"
 #include <QProcess>
 
 class PluginProcess : public QProcess
@@ -18,6 +19,16 @@ public:
         CALC,   ///< Opération de calcul pour un fragment donné
         UI      ///< Opération de récupération de la description de l'interface utilisateur
     };
+    /**
+     * @brief Cette énumération définit les différents types de plugins supportés
+     *      Le type inconnu n'existe pas, le type par défault utilisé est BINARY
+     */
+    enum Type {
+        BINARY,     ///< Binaire compilé
+        JAR,        ///< Archive JAR java
+        SCRIPT,     ///< Fichier script avec interpréteur sans #!/bin/... sinon considéré comme binaire
+        LIBRARY     ///< Bibliothèque partagée implémentant l'interface de pluginabi.h
+    };
     /**
      * @brief Construit une nouvelle instance de processus sur un calcul
      * @param calc
@@ -32,6 +43,35 @@ public:
      * @return retourne faux si aucun n'interpréteur n'a été trouvé pour le type script, sinon retourne toujours vrai
      */
     bool Start();
+    /**
+     * @brief Construit la commande de lancement d'un plugin en fonction de son type
+     * @param absExecDir
+     *      Répertoire des plugins
+     * @param bin
+     *      Nom du binaire du plugin
+     * @param command
+     *      Commande construite
+     * @return faux si aucun interpréteur n'a été trouvé pour le type script
+     */
+    static bool Command(const QString & absExecDir, const QString & bin, QString & command);
+    /**
+     * @brief Construit la commande de lancement d'un plugin en mode worker : un plugin JAR est
+     *      chargé une fois pour toutes dans l'hôte JVM résident, s'il est installé à côté de
+     *      l'application
+     * @see Command()
+     */
+    static bool WorkerCommand(const QString & absExecDir, const QString & bin, QString & command);
+    /**
+     * @brief Détecte le type de plugin (binaire compilé, JAR, script, bibliothèque)
+     *          Pour l'instant on se contente de regarder l'extension
+     * @return le type de plugin
+     */
+    static Type DetectType(const QString & bin);
+    /**
+     * @brief Transmet au calcul une ligne d'avancement (PROGRESS <n>) ou de reprise (CHECKPOINT <json>)
+     * @return vrai si la ligne était l'une des deux
+     */
+    static bool ReadSideChannel(Calculation * calc, const QByteArray & line);
 
 private slots:
     /**
@@ -49,30 +89,26 @@ private slots:
      *      Satut de fin du processus
      */
     void SLOT_FINISHED(int exitCode, QProcess::ExitStatus exitStatus);
-
-private:
     /**
-     * @brief Cette énumération définit les différents types de plugins supportés
-     *      Le type inconnu n'existe pas, le type par défault utilisé est BINARY
+     * @brief Ce slot lit la sortie du plugin au fil de l'eau : les lignes d'avancement
+     *      (PROGRESS <n>) et de reprise (CHECKPOINT <json>) sont transmises au calcul, le reste
+     *      est décodé et accumulé pour le résultat, même avant la fin de la ligne
      */
-    enum Type {
-        BINARY,     ///< Binaire compilé
-        JAR,        ///< Archive JAR java
-        SCRIPT      ///< Fichier script avec interpréteur sans #!/bin/... sinon considéré comme binaire
-    };
+    void SLOT_READ_OUTPUT();
     /**
-     * @brief Détecte le type de plugin (binaire compilé, JAR, script)
-     *          Pour l'instant on se contente de regarder l'extension
-     * @return le type de plugin
+     * @brief Ce slot lit la sortie d'erreur au fil de l'eau, seule sa fin est conservée
      */
-    Type detectType();
-    QString selectInterpreter();
+    void slot_readError();
+
+private:
+    static QString selectInterpreter(const QString & bin);
 
     QString _absExecDir;
     Calculation * _calculation;
     Operation _op;
-    QString _out;
-    QString _err;
+    PluginOutput _output;
+    bool _midLine;
+    QByteArray _err;
 };
 
 typedef QList<PluginProcess*> PluginProcessList;
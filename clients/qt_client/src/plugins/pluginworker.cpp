@@ -0,0 +1,146 @@
+#include "pluginworker.h"
+#include "src/calculation/specs.h"
+#include "src/utils/logger.h"
+
+#include <QElapsedTimer>
+
+PluginWorker::PluginWorker(QObject *parent) :
+    QProcess(parent),
+    _calculation(NULL),
+    _op(PluginProcess::SPLIT),
+    _buffer(),
+    _expected(-1),
+    _ok(false)
+{
+    connect(this, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(slot_finished(int,QProcess::ExitStatus)));
+}
+
+bool PluginWorker::Start(const QString &command, int timeout)
+{
+    start(command);
+    if(!waitForStarted(timeout))
+    {   return false;
+    }
+    // -- demande du mode worker : un plugin qui l'ignore échoue sur cette opération inconnue
+    write(CS_OP_WORKER);
+    write(CS_CRLF);
+    write(CS_EOF);
+    write(CS_CRLF);
+    QElapsedTimer timer;
+    timer.start();
+    while(!canReadLine())
+    {   int left = timeout - (int)timer.elapsed();
+        if(left <= 0 || state() != QProcess::Running || !waitForReadyRead(left))
+        {   return false;
+        }
+    }
+    if(readLine().trimmed() != CS_WORKER_HELLO)
+    {   return false;
+    }
+    // -- la suite de la sortie est lue au fil de l'eau
+    connect(this, SIGNAL(readyReadStandardOutput()), SLOT(slot_readOutput()));
+    return true;
+}
+
+void PluginWorker::Submit(Calculation *calc, PluginProcess::Operation op)
+{
+    QByteArray json;
+    const char * name = NULL;
+    switch (op) {
+    case PluginProcess::SPLIT:
+        name = CS_OP_SPLIT;
+        json = calc->ToJson().toUtf8();
+        break;
+    case PluginProcess::JOIN:
+        name = CS_OP_JOIN;
+        json = calc->FragmentsToJson().toUtf8();
+        break;
+    case PluginProcess::CALC:
+        name = CS_OP_CALC;
+        json = calc->ToJson().toUtf8();
+        LOG_DEBUG(QString("JSON param is : '%1'").arg(json.data()));
+        break;
+    case PluginProcess::UI:
+        name = CS_OP_UI;
+        break;
+    }
+    _calculation = calc;
+    _op = op;
+    write(QString("%1 %2").arg(name).arg(json.size()).toUtf8());
+    write(CS_CRLF);
+    write(json);
+}
+
+bool PluginWorker::WaitForResponse(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while(IsBusy() && state() == QProcess::Running)
+    {   int left = msecs - (int)timer.elapsed();
+        if(left <= 0 || !waitForReadyRead(left))
+        {   break;
+        }
+    }
+    return !IsBusy();
+}
+
+void PluginWorker::Close()
+{
+    closeWriteChannel();
+    if(!waitForFinished(1000))
+    {   kill();
+        waitForFinished();
+    }
+}
+
+void PluginWorker::slot_readOutput()
+{
+    _buffer.append(readAllStandardOutput());
+    forever
+    {   // -- en-tête de réponse, les lignes d'avancement et de reprise sont transmises au calcul
+        if(_expected < 0)
+        {   int eol = _buffer.indexOf('\n');
+            if(eol < 0) return;
+            QByteArray line = _buffer.left(eol + 1);
+            _buffer.remove(0, eol + 1);
+            if(_calculation && PluginProcess::ReadSideChannel(_calculation, line)) continue;
+            QList<QByteArray> header = line.trimmed().split(' ');
+            bool ok = header.size() == 2 && (header.at(0) == CS_WORKER_OK || header.at(0) == CS_WORKER_KO);
+            int size = ok ? header.at(1).toInt(&ok) : -1;
+            if(!ok || size < 0)
+            {   LOG_DEBUG(QString("Worker output ignored : '%1'").arg(QString(header.join(' '))));
+                continue;
+            }
+            _ok = header.at(0) == CS_WORKER_OK;
+            _expected = size;
+        }
+        // -- corps de la réponse
+        if(_buffer.size() < _expected) return;
+        QByteArray payload = _buffer.left(_expected);
+        _buffer.remove(0, _expected);
+        _expected = -1;
+        respond(_ok, payload);
+    }
+}
+
+void PluginWorker::slot_finished(int exitCode, QProcess::ExitStatus exitStatus)
+{   LOG_DEBUG(QString("Worker finished(%1,%2).").arg(exitCode).arg(exitStatus));
+    if(IsBusy())
+    {   LOG_ERROR(QString("Plugin worker exited during a request (exit_code=%1).").arg(exitCode));
+        respond(false, readAllStandardError());
+    }
+}
+
+void PluginWorker::respond(bool ok, const QByteArray &payload)
+{
+    // le worker est libéré avant de rendre la main au calcul, qui peut soumettre une autre requête
+    Calculation * calc = _calculation;
+    _calculation = NULL;
+    if(!calc) return;
+    if(ok)
+    {   calc->Slot_computed(QByteArray::fromPercentEncoding(payload));
+    }
+    else
+    {   calc->Slot_crashed(payload);
+    }
+}
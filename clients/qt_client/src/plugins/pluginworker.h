@@ -0,0 +1,70 @@
+#ifndef PLUGINWORKER_H
+#define PLUGINWORKER_H
+
+#include "pluginprocess.h"
+
+/**
+ * @brief Cette classe représente un plugin lancé une seule fois en mode worker : le processus
+ *      reste en vie et traite les requêtes qui lui sont soumises les unes après les autres.
+ *
+ *      Une requête est une ligne "<op> <taille>" suivie de taille octets de JSON, une réponse
+ *      une ligne "OK <taille>" ou "KO <taille>" suivie du résultat ou du message d'erreur.
+ */
+class PluginWorker : public QProcess
+{
+    Q_OBJECT
+public:
+    PluginWorker(QObject * parent = NULL);
+    ~PluginWorker(){} //do not delete calc here
+    /**
+     * @brief Démarre le plugin en mode worker et attend qu'il annonce le protocole
+     * @param command
+     *      Commande de lancement du plugin
+     * @param timeout
+     *      Délai maximal d'attente de l'annonce en millisecondes
+     * @return faux si le plugin n'a pas démarré ou ne connaît pas le mode worker
+     */
+    bool Start(const QString & command, int timeout);
+    /**
+     * @brief Soumet une opération sur un calcul au worker, le résultat est transmis au calcul
+     *      à réception de la réponse
+     */
+    void Submit(Calculation * calc, PluginProcess::Operation op);
+    /**
+     * @brief Attend la réponse à la requête en cours
+     * @return vrai si la réponse a été reçue avant le délai
+     */
+    bool WaitForResponse(int msecs = 30000);
+    /**
+     * @brief Indique si une requête est en cours de traitement
+     */
+    bool IsBusy() const { return _calculation != NULL; }
+    /**
+     * @brief Ferme l'entrée du worker et attend sa fin, le tue au besoin
+     */
+    void Close();
+
+private slots:
+    /**
+     * @brief Ce slot lit la sortie du worker au fil de l'eau et découpe les réponses
+     */
+    void slot_readOutput();
+    /**
+     * @brief Ce slot est appelé quand le processus du worker se termine
+     */
+    void slot_finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    /**
+     * @brief Transmet la réponse au calcul de la requête en cours
+     */
+    void respond(bool ok, const QByteArray & payload);
+
+    Calculation * _calculation;
+    PluginProcess::Operation _op;
+    QByteArray _buffer;
+    int _expected;
+    bool _ok;
+};
+
+#endif // PLUGINWORKER_H
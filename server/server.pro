@@ -35,7 +35,13 @@ SOURCES += \
     src/network/etat/workingabouttostartstate.cpp \
     src/network/etat/workingstate.cpp \
     src/plugins/pluginprocess.cpp \
-    src/calculation/fragment.cpp
+    src/calculation/fragment.cpp \
+    src/plugins/pluginworker.cpp \
+    src/plugins/libraryplugin.cpp \
+    src/plugins/librarytask.cpp \
+    src/plugins/pluginregistry.cpp \
+    src/plugins/plugincache.cpp \
+    src/plugins/pluginoutput.cpp
 
 HEADERS  += \
     src/console/consolehandler.h \
@@ -58,7 +64,14 @@ HEADERS  += \
     src/network/etat/workingstate.h \
     src/calculation/specs.h \
     src/plugins/pluginprocess.h \
-    src/calculation/fragment.h
+    src/calculation/fragment.h \
+    src/plugins/pluginworker.h \
+    src/calculation/pluginabi.h \
+    src/plugins/libraryplugin.h \
+    src/plugins/librarytask.h \
+    src/plugins/pluginregistry.h \
+    src/plugins/plugincache.h \
+    src/plugins/pluginoutput.h
 
 # retrieve host & build information
 DEFINES += QHOST_ARCH=\\\"$$QMAKE_HOST.arch\\\"
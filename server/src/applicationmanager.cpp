@@ -3,6 +3,15 @@
 #include "utils/logger.h"
 #include "console/consolehandler.h"
 #include "plugins/pluginmanager.h"
+#include "plugins/pluginoutput.h"
+
+#include <QCoreApplication>
+
+#define OPT_PLUGIN_JOBS "--plugin-jobs"
+#define OPT_ISOLATE_PLUGINS "--isolate-plugins"
+#define OPT_OUTPUT_MEMORY "--output-memory"
+#define OPT_BACKUP_THRESHOLD "--backup-threshold"
+
 ApplicationManager ApplicationManager::_instance;
 
 void ApplicationManager::Init()
@@ -33,10 +42,54 @@ void ApplicationManager::Init()
     // --- application_mgr --> plugin_mgr
     connect(this, SIGNAL(sig_terminateModule()),
             &(PluginManager::getInstance()), SLOT(Slot_terminate()));
+    // --- network_mgr --> plugin_mgr
+    connect(&(NetworkManager::getInstance()), SIGNAL(sig_waitingCalculationCountUpdated(int)),
+            &(PluginManager::getInstance()), SLOT(Slot_waitingFragmentsUpdated(int)));
 
     LOG_INFO("Initialisation des composants...");
     // -- initialisation des composants
     PluginManager::getInstance().Init();
+    // --- taille de l'exécuteur des opérations de plugin : --plugin-jobs <n>
+    QStringList args = qApp->arguments();
+    int opt = args.indexOf(OPT_PLUGIN_JOBS);
+    if(opt >= 0)
+    {   bool ok = false;
+        int jobs = (opt + 1 < args.size() ? args.at(opt + 1).toInt(&ok) : 0);
+        if(ok && jobs > 0)
+        {   PluginManager::getInstance().SetMaxJobs(jobs);
+        }
+        else
+        {   LOG_WARN(QString("Incorrect parameter : '%1' must be followed by a positive number !").arg(OPT_PLUGIN_JOBS));
+        }
+    }
+    // --- plugins bibliothèque exécutés hors du serveur : --isolate-plugins
+    if(args.contains(OPT_ISOLATE_PLUGINS))
+    {   PluginManager::getInstance().SetIsolatePlugins(true);
+    }
+    // --- sortie d'un plugin conservée en mémoire avant débordement sur disque : --output-memory <Mio>
+    opt = args.indexOf(OPT_OUTPUT_MEMORY);
+    if(opt >= 0)
+    {   bool ok = false;
+        int mib = (opt + 1 < args.size() ? args.at(opt + 1).toInt(&ok) : 0);
+        if(ok && mib >= 0)
+        {   PluginOutput::SetMemoryLimit((qint64)mib * 1024 * 1024);
+        }
+        else
+        {   LOG_WARN(QString("Incorrect parameter : '%1' must be followed by a number of MiB !").arg(OPT_OUTPUT_MEMORY));
+        }
+    }
+    // --- avancement à partir duquel les fragments lents sont dupliqués : --backup-threshold <pourcentage>
+    opt = args.indexOf(OPT_BACKUP_THRESHOLD);
+    if(opt >= 0)
+    {   bool ok = false;
+        int percent = (opt + 1 < args.size() ? args.at(opt + 1).toInt(&ok) : -1);
+        if(ok && percent >= 0 && percent <= 100)
+        {   NetworkManager::getInstance().SetBackupThreshold(percent);
+        }
+        else
+        {   LOG_WARN(QString("Incorrect parameter : '%1' must be followed by a percentage !").arg(OPT_BACKUP_THRESHOLD));
+        }
+    }
     if(!PluginManager::getInstance().CheckPlugins())
     {   LOG_CRITICAL("Plugins integrity check failed !");
     }
@@ -71,6 +124,7 @@ void ApplicationManager::Slot_state()
               "  + available : %6\n"
               "  + working   : %7\n"
               "  + total     : %8\n"
+              "  + backups   : %11 started, %12 finished first\n"
               "\n"
               "Timing stats :\n"
               "  + calculation average lifetime : %9\n"
@@ -87,7 +141,9 @@ void ApplicationManager::Slot_state()
             .arg(NetworkManager::getInstance().WorkingClientCount())
             .arg(NetworkManager::getInstance().ClientCount())
             .arg(CalculationManager::getInstance().AverageLifetime())
-            .arg(CalculationManager::getInstance().AverageFragmentCount());
+            .arg(CalculationManager::getInstance().AverageFragmentCount())
+            .arg(NetworkManager::getInstance().BackupCount())
+            .arg(NetworkManager::getInstance().BackupWinCount());
     LOG_DEBUG("sig_response(CMD_STATE) emitted.");
     emit sig_response(CMD_STATE, true, report);
 }
@@ -4,7 +4,6 @@
 #include "src/network/networkmanager.h"
 #include "src/plugins/pluginmanager.h"
 
-#include <QJsonArray>
 
 QString Calculation::StatusToString(Calculation::Status status)
 {
@@ -61,71 +60,162 @@ QString Calculation::ToJson(QJsonDocument::JsonFormat format) const
     calc.insert(CS_JSON_KEY_CALC_BIN, GetBin());
     calc.insert(CS_JSON_KEY_FRAG_ID, GetId().toString());
     calc.insert(CS_JSON_KEY_CALC_PARAMS, QJsonObject::fromVariantMap(_params));
+    // les plugins qui le supportent produisent un fragment par ligne, planifié dès sa lecture
+    calc.insert(CS_JSON_KEY_SPLIT_FORMAT, QString(CS_SPLIT_FORMAT_NDJSON));
     QJsonDocument doc(calc);
     return doc.toJson(format);
 }
 
 QString Calculation::FragmentsResultsToJson(QJsonDocument::JsonFormat format) const
-{   QJsonArray array;
+{   // en fusion incrémentale, il ne reste que quelques résultats partiels à fusionner
+    if(_joinMode == INCREMENTAL_JOIN)
+        return QJsonDocument(_joinPool).toJson(format);
 
-    foreach(Fragment *c, _fragments)// -- pour chaque fragment
-        array.append(c->GetResult());
+    QJsonArray array;
+
+    foreach(Fragment *c, _fragments)// -- pour chaque fragment calculé
+    {   if(!c->GetResult().isEmpty())
+            array.append(c->GetResult());
+    }
 
     return QJsonDocument(array).toJson(format);
 }
 
+QString Calculation::JoinGroupToJson(int group, QJsonDocument::JsonFormat format) const
+{
+    return QJsonDocument(_joinGroups.value(group)).toJson(format);
+}
+
+bool Calculation::ResultReceived(const QJsonObject &result)
+{
+    if(_joinMode != INCREMENTAL_JOIN || result.isEmpty())
+        return false;
+    if(_status != SCHEDULED && _status != BEING_COMPUTED)
+        return false;
+    _joinPool.append(result);
+    reduceJoinPool();
+    return true;
+}
+
+void Calculation::reduceJoinPool()
+{
+    while(_joinPool.size() >= JOIN_GROUP_SIZE)
+    {   QJsonArray group;
+        for(int i = 0; i < JOIN_GROUP_SIZE; ++i)
+            group.append(_joinPool.takeAt(0));
+        int id = _nextJoinGroup++;
+        _joinGroups.insert(id, group);
+        LOG_DEBUG(QString("Partial join of group %1 requested.").arg(id));
+        PluginManager::getInstance().PartialJoin(this, id);
+    }
+}
+
 void Calculation::Cancel()
 {
     LOG_DEBUG("Entering state CANCELED.");
     setCurrentStatus(CANCELED);
     updateProgress(100);
 
-    LOG_DEBUG("sig_canceled() emitted for all children.");
+    stopFragments();
+}
+
+void Calculation::CompleteEarly(const Fragment *fragment)
+{
+    if(_status != SCHEDULED && _status != BEING_COMPUTED)
+        return;
+    LOG_DEBUG(QString("Final result received from fragment %1.").arg(fragment->GetId().toString()));
+    stopFragments(fragment);
+
+    updateProgress(100 * _fragments.size());
+    startJoin();
+}
+
+void Calculation::stopFragments(const Fragment *except)
+{
+    // d'abord la file d'attente, sinon un client libéré par STOP reprendrait un fragment du calcul
+    NetworkManager::getInstance().RemoveWaitingFragments(this);
+
+    LOG_DEBUG("sig_canceled() emitted for children.");
     QHash<QUuid,Fragment*>::const_iterator fragment;
     for(fragment = _fragments.constBegin() ; fragment != _fragments.constEnd() ; fragment++)
-        emit fragment.value()->sig_canceled();
+    {   if(fragment.value() != except)
+            emit fragment.value()->sig_canceled();
+    }
 }
 
 void Calculation::Splitted(const QByteArray & json)
 {
-    LOG_DEBUG(QString("Splitted received json=%1").arg(QString(json)));
+    LOG_DEBUG(QString("Splitted received %1 bytes.").arg(json.size()));
 
-    QJsonParseError jsonError;
-    QJsonDocument doc = QJsonDocument::fromJson(json, &jsonError);
-    if(jsonError.error != QJsonParseError::NoError)
-    {   LOG_ERROR("an error occured while parsing splitted json block.");
-        setCurrentStatus(CRASHED);
-        return;
-    }
-    QJsonArray fragments = doc.array();
-    foreach (QJsonValue fragment, fragments)
-    {
-        QString error;
-        Fragment * frag = Fragment::FromJson(this, QJsonDocument(fragment.toObject()).toJson(QJsonDocument::Compact), error);
-        if(frag != NULL)
-        {   _fragments.insert(frag->GetId(), frag);
-            connect(frag, &Fragment::sig_progressUpdated, this, &Calculation::slot_updateChildrenProgress);
-        }
-        else
-        {   LOG_ERROR("fragment creation failed !");
-            setCurrentStatus(CRASHED);
+    if(json.trimmed().startsWith('['))
+    {   // -- tableau JSON de fragments
+        QJsonParseError jsonError;
+        QJsonDocument doc = QJsonDocument::fromJson(json, &jsonError);
+        if(jsonError.error != QJsonParseError::NoError)
+        {   Crashed("an error occured while parsing splitted json block.");
             return;
         }
+        foreach (QJsonValue fragment, doc.array())
+        {   if(!FragmentSplitted(QJsonDocument(fragment.toObject()).toJson(QJsonDocument::Compact)))
+                return;
+        }
     }
+    else
+    {   // -- un fragment JSON par ligne
+        foreach (QByteArray line, json.split('\n'))
+        {   line = line.trimmed();
+            if(!line.isEmpty() && !FragmentSplitted(line))
+                return;
+        }
+    }
+    SplitFinished();
+}
 
-    // mise à jour de l'état du calcul
-    LOG_DEBUG("Entering state SCHEDULED.");
-    setCurrentStatus(SCHEDULED);
+bool Calculation::FragmentSplitted(const QByteArray &json)
+{
+    if(_status != BEING_SPLITTED && _status != SCHEDULED && _status != BEING_COMPUTED)
+        return false;
+
+    QString error;
+    Fragment * frag = Fragment::FromJson(this, json, error);
+    if(frag == NULL)
+    {   Crashed(QString("fragment creation failed : %1").arg(error));
+        return false;
+    }
+    // politique de terminaison déclarée par le plugin
+    QJsonObject object = QJsonDocument::fromJson(json).object();
+    if(object.value(CS_JSON_KEY_COMPLETION).toString() == CS_COMPLETION_FIRST)
+        _completion = FIRST_RESULT;
+    // mode de fusion déclaré par le plugin
+    if(object.value(CS_JSON_KEY_JOIN).toString() == CS_JOIN_INCREMENTAL)
+        _joinMode = INCREMENTAL_JOIN;
+    _fragments.insert(frag->GetId(), frag);
+    connect(frag, &Fragment::sig_progressUpdated, this, &Calculation::slot_updateChildrenProgress);
+
+    // mise à jour de l'état du calcul au premier fragment
+    if(_status == BEING_SPLITTED)
+    {   LOG_DEBUG("Entering state SCHEDULED.");
+        setCurrentStatus(SCHEDULED);
+    }
     LOG_DEBUG("SIG_SCHEDULED() emitted.");
+    emit sig_scheduled(frag);
+    return true;
+}
 
-    QHash<QUuid,Fragment*>::const_iterator fragment;
-    for(fragment = _fragments.constBegin() ; fragment != _fragments.constEnd() ; fragment++)
-        emit sig_scheduled(fragment.value());
+void Calculation::SplitFinished()
+{
+    _splitDone = true;
+    if(_status == BEING_SPLITTED)
+    {   LOG_DEBUG("Entering state SCHEDULED.");
+        setCurrentStatus(SCHEDULED);
+    }
+    // les fragments ont pu être tous calculés pendant la fragmentation
+    joinIfComplete();
 }
 
 void Calculation::Joined(const QByteArray &json)
 {
-    LOG_DEBUG(QString("Joined received json=%1").arg(QString(json)));
+    LOG_DEBUG(QString("Joined received %1 bytes.").arg(json.size()));
 
     QJsonParseError jsonError;
     QJsonDocument doc = QJsonDocument::fromJson(json, &jsonError);
@@ -137,7 +227,8 @@ void Calculation::Joined(const QByteArray &json)
     }
     _result = doc.object();
 
-    //Nettoyage des fragments
+    //Nettoyage des fragments et des résultats intermédiaires
+    _joinPool = QJsonArray();
     qDeleteAll(_fragments);
     _fragments.clear();
 
@@ -148,6 +239,32 @@ void Calculation::Joined(const QByteArray &json)
     emit sig_calculationDone(GetId(), GetResult());
 }
 
+void Calculation::PartialJoined(int group, const QByteArray &json)
+{
+    LOG_DEBUG(QString("PartialJoined received group=%1, %2 bytes.").arg(group).arg(json.size()));
+
+    _joinGroups.remove(group);
+    if(_status != SCHEDULED && _status != BEING_COMPUTED && _status != BEING_JOINED)
+        return;
+
+    QJsonParseError jsonError;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &jsonError);
+    if(jsonError.error != QJsonParseError::NoError || !doc.isObject())
+    {   Crashed("an error occured while parsing partially joined json block.");
+        return;
+    }
+    // le résultat partiel est fusionné avec les autres, comme un résultat de fragment
+    _joinPool.append(doc.object());
+    if(_status == BEING_JOINED)
+    {   if(_joinGroups.isEmpty())
+        {   PluginManager::getInstance().Join(this);
+        }
+    }
+    else
+    {   reduceJoinPool();
+    }
+}
+
 void Calculation::Crashed(QString error)
 {
     LOG_ERROR(QString("Calculation crashed due to the following reason : %1").arg(error.isEmpty() ? "<unknown_reason>" : error));
@@ -155,6 +272,9 @@ void Calculation::Crashed(QString error)
     LOG_DEBUG("Entering state CRASHED.");
     updateProgress(0);
     setCurrentStatus(CRASHED);
+    // une fragmentation en flux a pu planifier des fragments avant d'échouer
+    if(!_fragments.isEmpty())
+        stopFragments();
 }
 
 void Calculation::Slot_started()
@@ -175,28 +295,55 @@ void Calculation::setCurrentStatus(Calculation::Status status)
 Calculation::Calculation(const QString & bin, const QVariantMap &params, QObject * parent) :
     AbstractIdentifiable(parent),
     _status(BEING_SPLITTED),
+    _completion(ALL_RESULTS),
+    _joinMode(FINAL_JOIN),
     _bin(bin),
     _params(params),
     _fragments(),
-    _progress(0)
+    _progress(0),
+    _splitDone(false),
+    _joinPool(),
+    _joinGroups(),
+    _nextJoinGroup(0)
 {
 }
 
 void Calculation::slot_updateChildrenProgress(int oldChildProgress, int newChildProgress)
 {
+    if (_status != SCHEDULED && _status != BEING_COMPUTED)
+        return;
+
     updateProgress(_progress - oldChildProgress + newChildProgress);
+    joinIfComplete();
+}
+
+void Calculation::joinIfComplete()
+{
+    if (_status != SCHEDULED && _status != BEING_COMPUTED)
+        return;
+    // tant que la fragmentation continue, d'autres fragments peuvent arriver
+    if (!_splitDone || _fragments.isEmpty())
+        return;
 
     if (_progress/_fragments.size() >= 100)//Si tous les fragments on terminé le calcul...
     {
-        LOG_DEBUG("Entering state BEING_JOINED.");
-        setCurrentStatus(BEING_JOINED);
-        PluginManager::getInstance().Join(this);
+        startJoin();
     }
 }
 
+void Calculation::startJoin()
+{
+    LOG_DEBUG("Entering state BEING_JOINED.");
+    setCurrentStatus(BEING_JOINED);
+    // sinon la fusion finale est lancée à la fin de la dernière fusion partielle
+    if(_joinGroups.isEmpty())
+        PluginManager::getInstance().Join(this);
+}
+
 void Calculation::updateProgress(int progress)
 {
-    LOG_DEBUG("New progress for " + GetId().toString() + " : " + QString::number(progress/_fragments.size()));
+    int count = qMax(_fragments.size(), 1);
+    LOG_DEBUG("New progress for " + GetId().toString() + " : " + QString::number(progress/count));
     _progress = progress;
-    emit sig_progressUpdated(GetId(), _progress/_fragments.size());
+    emit sig_progressUpdated(GetId(), _progress/count);
 }
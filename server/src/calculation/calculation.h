@@ -4,6 +4,10 @@
 #include "fragment.h"
 #include "../const.h"
 #include <QHash>
+#include <QJsonArray>
+
+// nombre de résultats fusionnés par chaque fusion partielle en mode incrémental
+#define JOIN_GROUP_SIZE 8
 
 /**
  * @brief Cette classe représente un calcul distribuable
@@ -26,6 +30,24 @@ public:
     };
     static QString StatusToString(Status state);
 
+    /**
+     * @brief Cette énumération décrit les politiques de terminaison d'un calcul, déclarées par
+     *        le plugin dans les fragments produits par l'opération split
+     */
+    enum Completion {
+        ALL_RESULTS,    // le calcul attend le résultat de tous ses fragments
+        FIRST_RESULT    // le premier résultat marqué final termine le calcul
+    };
+
+    /**
+     * @brief Cette énumération décrit les modes de fusion d'un calcul, déclarés par le plugin
+     *        dans les fragments produits par l'opération split
+     */
+    enum JoinMode {
+        FINAL_JOIN,         // tous les résultats sont fusionnés en une fois, à la fin du calcul
+        INCREMENTAL_JOIN    // les résultats sont fusionnés par groupes au fil de leur arrivée
+    };
+
     ~Calculation(){}
 
     /**
@@ -34,12 +56,23 @@ public:
      */
     inline int GetFragmentCount() const { return _fragments.count(); }
 
+    /**
+     * @brief Indique si tous les fragments du calcul ont été produits
+     */
+    inline bool IsSplitDone() const { return _splitDone; }
+
     /**
      * @brief Etat du calcul
      * @return
      */
     inline Status GetStatus() const { return _status; }
 
+    /**
+     * @brief Politique de terminaison du calcul
+     * @return
+     */
+    inline Completion GetCompletion() const { return _completion; }
+
     /**
      * @brief Binaire utilisé pour les operations split, calc et join
      * @return
@@ -75,11 +108,33 @@ public:
      */
     QString FragmentsResultsToJson(QJsonDocument::JsonFormat format = QJsonDocument::Compact) const;
 
+    /**
+     * @brief Donne la représentation JSON d'un groupe de résultats en cours de fusion partielle
+     * @param group identifiant du groupe
+     * @return
+     */
+    QString JoinGroupToJson(int group, QJsonDocument::JsonFormat format = QJsonDocument::Compact) const;
+
+    /**
+     * @brief Cette méthode est appelée à la réception du résultat d'un fragment
+     * @param result
+     * @return vrai si le résultat a été pris en charge par la fusion incrémentale, le fragment
+     *      n'a alors plus à le conserver
+     */
+    bool ResultReceived(const QJsonObject &result);
+
     /**
     * @brief Demande l'annulation du calcul
     */
     void Cancel();
 
+    /**
+     * @brief Termine le calcul sans attendre les autres fragments : les fragments en cours sont
+     *        arrêtés, ceux en attente retirés de la file, puis les résultats sont fusionnés
+     * @param fragment le fragment dont le résultat final a été reçu
+     */
+    void CompleteEarly(const Fragment * fragment);
+
     /**
      * @brief Cette méthode est appelée quand le calcul à crashé
      * @param error message d'erreur
@@ -89,15 +144,38 @@ public:
     /**
      * @brief Cette méthode est appelée une fois le calcul fragmenté
      * @param json
+     *      Tableau JSON des fragments, ou un fragment JSON par ligne
      */
     void Splitted(const QByteArray &json);
 
+    /**
+     * @brief Cette méthode est appelée pour chaque fragment d'une fragmentation en flux, le
+     *        fragment est planifié sans attendre la fin de la fragmentation
+     * @param json
+     *      Fragment JSON
+     * @return faux si le calcul n'accepte plus de fragment (annulé, terminé ou fragment invalide)
+     */
+    bool FragmentSplitted(const QByteArray &json);
+
+    /**
+     * @brief Cette méthode est appelée à la fin d'une fragmentation en flux
+     */
+    void SplitFinished();
+
     /**
      * @brief Cette méthode est appelée une fois les résultats du calcul fusionnés
      * @param json
      */
     void Joined(const QByteArray &json);
 
+    /**
+     * @brief Cette méthode est appelée une fois un groupe de résultats fusionné, le résultat
+     *        partiel rejoint les résultats en attente de fusion
+     * @param group identifiant du groupe
+     * @param json
+     */
+    void PartialJoined(int group, const QByteArray &json);
+
 public slots:
     /**
      * @brief Cette méthode est appelée quand le calcul commence
@@ -143,6 +221,27 @@ private:
      */
     void updateProgress(int progress);
 
+    /**
+     * @brief Retire les fragments en attente de la file et arrête ceux en cours de calcul
+     * @param except fragment à épargner, NULL pour tous les arrêter
+     */
+    void stopFragments(const Fragment * except = NULL);
+
+    /**
+     * @brief Lance la fusion si la fragmentation est terminée et tous les fragments calculés
+     */
+    void joinIfComplete();
+
+    /**
+     * @brief Passe le calcul en fusion, la fusion finale attend la fin des fusions partielles
+     */
+    void startJoin();
+
+    /**
+     * @brief Lance une fusion partielle pour chaque groupe complet de résultats en attente
+     */
+    void reduceJoinPool();
+
     // non instanciable autrement qu'en fabrique et non copiable
     Calculation(const QString &bin, const QVariantMap &params, QObject * parent = NULL);
     Q_DISABLE_COPY(Calculation)
@@ -157,10 +256,17 @@ private:
 
     // attributs
     Status _status;
+    Completion _completion;
+    JoinMode _joinMode;
     QString _bin;
     QVariantMap _params;
     QHash<QUuid,Fragment*> _fragments;
     int _progress;
+    bool _splitDone;
     QJsonObject _result;
+    // fusion incrémentale : résultats en attente et groupes en cours de fusion
+    QJsonArray _joinPool;
+    QHash<int,QJsonArray> _joinGroups;
+    int _nextJoinGroup;
 };
 #endif // CALCULATION_H
@@ -7,13 +7,17 @@
 #include "src/network/networkmanager.h"
 #include "../utils/logger.h"
 #include "calculation.h"
+#include "src/plugins/pluginmanager.h"
 
 Fragment::Fragment(const QString &bin, const QVariantMap &params, Calculation * parent) :
     AbstractIdentifiable(parent),
     _bin(bin),
     _calculation(parent),
     _params(params),
-    _progress(0)
+    _checkpoint(),
+    _progress(0),
+    _estimate(0),
+    _merged(false)
 {
 
 }
@@ -28,7 +32,16 @@ QString Fragment::ToJson(QJsonDocument::JsonFormat format) const
     QJsonObject frag;
     frag.insert(CS_JSON_KEY_CALC_BIN, GetBin());
     frag.insert(CS_JSON_KEY_FRAG_ID, GetId().toString());
-    frag.insert(CS_JSON_KEY_CALC_PARAMS, QJsonObject::fromVariantMap(_params));
+    // empreinte du plugin : le client ne le télécharge que si sa copie est différente
+    QString hash = PluginManager::getInstance().GetPluginHash(GetBin());
+    if(!hash.isEmpty())
+    {   frag.insert(CS_JSON_KEY_BIN_HASH, hash);
+    }
+    // reprise depuis le dernier point de reprise s'il y en a un
+    QVariantMap params = _params;
+    for(QVariantMap::const_iterator it = _checkpoint.constBegin(); it != _checkpoint.constEnd(); ++it)
+        params.insert(it.key(), it.value());
+    frag.insert(CS_JSON_KEY_CALC_PARAMS, QJsonObject::fromVariantMap(params));
     QJsonDocument doc(frag);
     return doc.toJson(format);
 }
@@ -54,6 +67,8 @@ Fragment * Fragment::FromJson(Calculation * parent, const QByteArray &json, QStr
             {   fragment = new Fragment(doc.object().value(CS_JSON_KEY_CALC_BIN).toString(),
                                               doc.object().value(CS_JSON_KEY_CALC_PARAMS).toObject().toVariantMap(),
                                               parent);
+                // durée estimée en secondes, facultative
+                fragment->_estimate = (qint64)(doc.object().value(CS_JSON_KEY_FRAG_ESTIMATE).toDouble() * 1000);
             }
         }
         else
@@ -68,13 +83,37 @@ Fragment * Fragment::FromJson(Calculation * parent, const QByteArray &json, QStr
 
 void Fragment::Slot_computed(const QJsonObject &json)
 {
+    // un résultat déjà reçu (fusionné ou non) ne doit pas être pris en compte deux fois : le
+    // fragment a pu être réattribué après l'expiration de son bail
+    if(_merged || _progress == 100)
+    {   LOG_DEBUG("Late result ignored for fragment " + GetId().toString());
+        return;
+    }
     _result = json;
+    bool final = IsFinal();
+    // en fusion incrémentale le résultat est confié au calcul et n'est plus conservé ici
+    if(_calculation->ResultReceived(_result))
+    {   _result = QJsonObject();
+        _merged = true;
+    }
 
     // mise à jour de l'état du calcul
     LOG_DEBUG("Entering state COMPUTED.");
+    if(final && _calculation->GetCompletion() == Calculation::FIRST_RESULT)
+    {   // le résultat suffit : les fragments frères sont abandonnés
+        _progress = 100;
+        _calculation->CompleteEarly(this);
+        return;
+    }
     Slot_updateProgress(100);
 }
 
+void Fragment::Slot_checkpoint(const QJsonObject &checkpoint)
+{
+    LOG_DEBUG("New checkpoint for fragment " + GetId().toString());
+    _checkpoint = checkpoint.toVariantMap();
+}
+
 void Fragment::Slot_updateProgress(int progress)
 {
     LOG_DEBUG("New progress for fragment " + GetId().toString() + " : " + QString::number(progress));
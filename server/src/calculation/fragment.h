@@ -2,6 +2,7 @@
 #define FRAGMENT_H
 
 #include "../utils/abstractidentifiable.h"
+#include "specs.h"
 #include <QVariantMap>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -23,6 +24,12 @@ public:
      */
     inline const QJsonObject & GetResult() const { return _result; }
 
+    /**
+     * @brief Indique si le résultat du fragment suffit à terminer le calcul
+     * @return vrai si le plugin a marqué le résultat comme final
+     */
+    inline bool IsFinal() const { return _result.value(CS_JSON_KEY_FRAG_FINAL).toBool(); }
+
     /**
      * @brief Binaire utilisé pour les operations split, calc et join
      * @return
@@ -51,6 +58,12 @@ public:
     */
     inline int GetProgress() const { return _progress; }
 
+    /**
+     * @brief Retourne la durée de calcul estimée par le plugin lors de la fragmentation
+     * @return durée en millisecondes, 0 si le plugin n'en a pas donné
+     */
+    inline qint64 GetEstimate() const { return _estimate; }
+
 public slots:
     /**
      * @brief Ce slot est appelée une fois le calcul effectué
@@ -64,6 +77,13 @@ public slots:
      */
     void Slot_updateProgress(int progress);
 
+    /**
+     * @brief Ce slot conserve le dernier point de reprise transmis par le client : si le fragment
+     *        est réattribué, ses paramètres remplacent ceux du fragment
+     * @param checkpoint paramètres de reprise fournis par le plugin
+     */
+    void Slot_checkpoint(const QJsonObject &checkpoint);
+
 signals:
     /**
      * @brief Ce signal est émis lorsque le calcul doit être annulé
@@ -84,7 +104,10 @@ private:
     QString _bin;
     Calculation *_calculation;
     QVariantMap _params;
+    QVariantMap _checkpoint;
     int _progress;
+    qint64 _estimate;
+    bool _merged;
     QJsonObject _result;
 };
 
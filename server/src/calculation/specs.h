@@ -5,13 +5,34 @@
 #define CS_JSON_KEY_CALC_PARAMS "params"
 #define CS_JSON_KEY_FRAG_ID     "fragment_id"
 #define CS_JSON_KEY_CALC_RESULT "result"
+#define CS_JSON_KEY_COMPLETION  "completion"
+#define CS_JSON_KEY_FRAG_FINAL  "final"
+#define CS_JSON_KEY_SPLIT_FORMAT "split_format"
+#define CS_JSON_KEY_JOIN        "join"
+#define CS_JSON_KEY_BIN_HASH    "bin_hash"
+#define CS_JSON_KEY_FRAG_ESTIMATE "estimate"
+
+#define CS_COMPLETION_ALL   "all"
+#define CS_COMPLETION_FIRST "first"
+
+#define CS_SPLIT_FORMAT_NDJSON "ndjson"
+
+#define CS_JOIN_FINAL       "final"
+#define CS_JOIN_INCREMENTAL "incremental"
 
 #define CS_OP_SPLIT "split"
 #define CS_OP_JOIN  "join"
 #define CS_OP_CALC  "calc"
+#define CS_OP_BENCH "bench"
 #define CS_OP_PARAM "get_params"
 #define CS_OP_UI    "ui"
 #define CS_EOF      "EOF"
+#define CS_PROGRESS "PROGRESS"
+#define CS_CHECKPOINT "CHECKPOINT"
+#define CS_OP_WORKER    "worker"
+#define CS_WORKER_HELLO "WORKER 1"
+#define CS_WORKER_OK    "OK"
+#define CS_WORKER_KO    "KO"
 #define CS_CRLF     "\n"
 
 #define CS_PLUGINPARAMS_NAME "name"
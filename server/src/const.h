@@ -48,8 +48,23 @@ enum ReqType {
     KO                  = 0x09,
     DO                  = 0x0A,
     STOP                = 0x0B,
-    BIN                 = 0x0C
+    BIN                 = 0x0C,
+    PROGRESS            = 0x0D,
+    CHECKPOINT          = 0x0E,
+    HEARTBEAT           = 0x0F
 };
 
+/**
+ * @brief Transfert d'un plugin par morceaux : le client l'annonce dans sa commande UNABLE, le
+ *      serveur envoie alors une suite de commandes BIN dont le premier octet porte les drapeaux
+ *      ci-dessous, suivi du morceau (compressé par qCompress si BIN_CHUNK_COMPRESSED)
+ */
+#define BIN_KEY_CHUNKED         "chunked"
+#define BIN_KEY_ENCODINGS       "encodings"
+#define BIN_ENCODING_QCOMPRESS  "qcompress"
+#define BIN_CHUNK_SIZE          (256 * 1024) // octets non compressés par morceau
+#define BIN_CHUNK_LAST          0x01
+#define BIN_CHUNK_COMPRESSED    0x02
+
 
 #endif // CONST_H
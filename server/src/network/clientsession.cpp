@@ -12,13 +12,24 @@
 /// Ce type est celui utilisé pour stocker la commande associée à un message
 typedef quint8  req_t;
 
+/// Nombre d'octets en attente d'écriture au delà duquel le morceau suivant attend
+#define BIN_WRITE_WINDOW (2 * BIN_CHUNK_SIZE)
+
 ClientSession::ClientSession(QTcpSocket *associatedSocket, QObject *parent) :
     AbstractIdentifiable(parent),
     _fragment(NULL),
     _socket(associatedSocket),
-    _blockSize(0)
+    _blockSize(0),
+    _pluginTransfer(),
+    _pluginOffset(0),
+    _pluginCompress(false),
+    _leaseTimer(),
+    _leaseClock()
 {
+    _leaseTimer.setSingleShot(true);
+    connect(&_leaseTimer, &QTimer::timeout, this, &ClientSession::slot_leaseExpired);
     connect(_socket, &QTcpSocket::readyRead, this, &ClientSession::slot_processReadyRead);
+    connect(_socket, &QTcpSocket::bytesWritten, this, &ClientSession::slot_sendPluginChunks);
     connect(_socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(slot_disconnect()));
     initializeStateMachine();
 }
@@ -36,6 +47,7 @@ void ClientSession::AddMissingPlugin()
 
 void ClientSession::slot_disconnect()
 {
+    cancelPluginTransfer();
     _currentState->OnExit();
     _currentState = _disconnectedState;
     _currentState->OnEntry();
@@ -64,6 +76,11 @@ void ClientSession::initializeStateMachine()
 
 void ClientSession::slot_processRequest(ReqType reqType, const QByteArray & content)
 {
+    // seule une sortie du plugin renouvelle le bail : un client dont le plugin est bloqué
+    // reste connecté et continue d'envoyer des HEARTBEAT
+    if (_leaseTimer.isActive() && (reqType == PROGRESS || reqType == CHECKPOINT))
+        _leaseTimer.start();
+
     switch (reqType)
     {
         case HELLO:
@@ -86,10 +103,22 @@ void ClientSession::slot_processRequest(ReqType reqType, const QByteArray & cont
             LOG_DEBUG("processing DONE request");
             _currentState->ProcessDone(content);
             break;
+        case PROGRESS:
+            LOG_DEBUG("processing PROGRESS request");
+            _currentState->ProcessProgress(content);
+            break;
+        case CHECKPOINT:
+            LOG_DEBUG("processing CHECKPOINT request");
+            _currentState->ProcessCheckpoint(content);
+            break;
         case ABORT:
             LOG_DEBUG("processing ABORT request");
             _currentState->ProcessAbort(content);
             break;
+        case HEARTBEAT:
+            // la connexion est active, sans effet sur le bail
+            LOG_DEBUG("processing HEARTBEAT request");
+            break;
         default:
             LOG_DEBUG(QString("Impossible de traiter cette requète : " + QString::number(reqType)));
             break;
@@ -126,8 +155,12 @@ void ClientSession::slot_processReadyRead()
 void ClientSession::resetCurrentFragment()
 {
     disconnect(this, &ClientSession::sig_calculDone, _fragment, &Fragment::Slot_computed);
+    disconnect(this, &ClientSession::sig_calculProgress, _fragment, &Fragment::Slot_updateProgress);
+    disconnect(this, &ClientSession::sig_calculCheckpoint, _fragment, &Fragment::Slot_checkpoint);
     disconnect(this, &ClientSession::sig_calculStarted, _fragment->GetCalculation(), &Calculation::Slot_started);
     disconnect(_fragment, &Fragment::sig_canceled, this, &ClientSession::Slot_stopCalcul);
+    cancelPluginTransfer();
+    _leaseTimer.stop();
     _fragment = NULL;
 }
 
@@ -139,18 +172,89 @@ void ClientSession::send(ReqType reqType, const QByteArray & content)
         return;
     }
 
-    QByteArray block;                           // on crée le bloc de données
-    QDataStream out(&block, QIODevice::WriteOnly);  // on crée un datastream pour normaliser le bloc
+    QByteArray header;                          // on crée l'en-tête du bloc de données
+    QDataStream out(&header, QIODevice::WriteOnly); // on crée un datastream pour normaliser le bloc
     out.setVersion(QDataStream::Qt_5_3);            // on donne la version du datastream pour spécifier la normalisation
 
     out << (msg_size_t)0;                                   // on reserve sizeof(msg_size_t) pour stocker la taille du message
     out << (req_t)reqType;                                  // on écrit dans le champs requete
-    out << content;                                // on écrit le contenu après la requete
+    // en-tête du contenu tel que l'écrirait le datastream, le contenu lui-même n'est pas recopié
+    out << (quint32)(content.isNull() ? 0xFFFFFFFF : content.size());
     out.device()->seek(0);                                  // on déplace la tête d'écriture au début
-    out << (msg_size_t)(block.size() - (int)sizeof(msg_size_t)); // on écrit la taille du message (commande comprise)
+    out << (msg_size_t)(header.size() + content.size() - (int)sizeof(msg_size_t)); // on écrit la taille du message (commande comprise)
 
-    _socket->write(block);  // on écrit le bloc dans le socket
-    _socket->flush();       // on flush le socket
+    _socket->write(header);     // on écrit l'en-tête dans le socket
+    _socket->write(content);    // puis le contenu à la suite
+    _socket->flush();           // on flush le socket
+}
+
+void ClientSession::sendPlugin(const MappedPluginPtr &plugin, bool chunked, bool compress)
+{
+    if(!chunked)
+    {   // -- ancien protocole : le plugin entier en une seule commande
+        send(BIN, plugin->GetData());
+        return;
+    }
+    _pluginTransfer = plugin;
+    _pluginOffset = 0;
+    _pluginCompress = compress;
+    slot_sendPluginChunks();
+}
+
+void ClientSession::cancelPluginTransfer()
+{
+    _pluginTransfer.clear();
+    _pluginOffset = 0;
+}
+
+void ClientSession::slot_sendPluginChunks()
+{
+    // -- on ne remplit pas le tampon du socket au delà de la fenêtre : les morceaux suivants
+    //    partiront à mesure que les précédents sont écrits
+    while(_pluginTransfer && _socket->bytesToWrite() < BIN_WRITE_WINDOW)
+    {   const QByteArray & data = _pluginTransfer->GetData();
+        int size = qMin(BIN_CHUNK_SIZE, data.size() - _pluginOffset);
+        QByteArray chunk = QByteArray::fromRawData(data.constData() + _pluginOffset, size);
+        quint8 flags = 0;
+        _pluginOffset += size;
+        if(_pluginOffset >= data.size())
+        {   flags |= BIN_CHUNK_LAST;
+        }
+        QByteArray payload;
+        if(_pluginCompress && size > 0)
+        {   payload = qCompress(chunk);
+        }
+        // -- le morceau compressé n'est gardé que s'il est plus petit
+        if(!payload.isNull() && payload.size() < size)
+        {   flags |= BIN_CHUNK_COMPRESSED;
+        }
+        else
+        {   payload = chunk;
+        }
+        QByteArray content;
+        content.reserve(1 + payload.size());
+        content.append((char)flags);
+        content.append(payload);
+        send(BIN, content);
+        if(flags & BIN_CHUNK_LAST)
+        {   cancelPluginTransfer();
+        }
+    }
+}
+
+void ClientSession::slot_leaseExpired()
+{
+    if (_fragment == NULL)
+        return;
+    LOG_WARN(QString("Lease of fragment %1 expired on client %2, closing its session.")
+             .arg(_fragment->GetId().toString()).arg(GetId().toString()));
+    emit sig_leaseExpired(this);
+    // le client arrête son plugin bloqué, puis le fragment est réattribué comme pour une
+    // déconnexion : un résultat tardif ne peut plus arriver
+    send(STOP);
+    _socket->abort();
+    if (_currentState != _disconnectedState)
+        slot_disconnect();
 }
 
 void ClientSession::setCurrentState(const QMap<QObject *, AbstractState *> &transitionsMap)
@@ -176,7 +280,7 @@ void ClientSession::setCurrentStateAfterSuccess()
     setCurrentState(_doneTransitionsMap);
 }
 
-bool ClientSession::StartCalcul(const Fragment *fragment)
+bool ClientSession::StartCalcul(const Fragment *fragment, int lease)
 {
     //Impossible de commencer un autre calcul quand il y en a un en cours ou
     //que le client n'a pas le plugin nécessaire
@@ -185,9 +289,13 @@ bool ClientSession::StartCalcul(const Fragment *fragment)
 
     connect(this, &ClientSession::sig_calculStarted, fragment->GetCalculation(), &Calculation::Slot_started);
     connect(this, &ClientSession::sig_calculDone, fragment, &Fragment::Slot_computed);
+    connect(this, &ClientSession::sig_calculProgress, fragment, &Fragment::Slot_updateProgress);
+    connect(this, &ClientSession::sig_calculCheckpoint, fragment, &Fragment::Slot_checkpoint);
     connect(fragment, &Fragment::sig_canceled, this, &ClientSession::Slot_stopCalcul);
 
     _fragment = fragment;
+    _leaseTimer.start(lease);
+    _leaseClock.start();
     emit sig_calculStarted();
     _currentState->ProcessDo(fragment->ToJson().toUtf8());
     return true;
@@ -197,6 +305,7 @@ void ClientSession::Slot_stopCalcul()
 {
     if (_fragment == NULL)
         return;
-    _currentState->ProcessStop();
+    // le fragment est libéré avant le STOP : le client redevenu prêt peut en recevoir un autre
     resetCurrentFragment();
+    _currentState->ProcessStop();
 }
@@ -2,9 +2,12 @@
 #define CLIENT_SESSION_H
 
 #include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "src/network/etat/abstractstate.h"
 #include "src/utils/abstractidentifiable.h"
 #include "../calculation/calculation.h"
+#include "src/plugins/plugincache.h"
 
 /// Ce type est celui utilisé pour stocker la taille d'un message et taille maximale associée
 typedef quint32 msg_size_t;
@@ -50,14 +53,28 @@ public:
      */
     inline const Fragment *GetFragment() const;
 
+    /**
+     * @brief Retourne la durée écoulée depuis l'attribution du fragment en cours,
+     *        téléchargement du plugin compris
+     * @return durée en millisecondes
+     */
+    inline qint64 GetCalculElapsed() const;
+
+    /**
+     * @brief Retourne l'adresse de la machine du client, nulle une fois la session fermée
+     */
+    inline QHostAddress GetPeerAddress() const;
+
     /**
      * @brief Demande au client de démarrer le calcul donné
      * @param fragmentId l'id du fragment de calcul (utile pour stopper
      *                   éventuellement le calcul)
      * @param args les arguments de calcul à transmettre au client
+     * @param lease durée du bail en millisecondes : sans PROGRESS ni CHECKPOINT du plugin
+     *              pendant cette durée, la session est fermée et le fragment réattribué
      * @return true si le calcul à pu démarrer, false sinon (si un calcul est déja en cours)
      */
-    bool StartCalcul(const Fragment *fragment);
+    bool StartCalcul(const Fragment *fragment, int lease);
 
 public slots:
     /**
@@ -78,6 +95,31 @@ signals:
      */
     void sig_calculDone(const QJsonObject &json);
 
+    /**
+     * @brief Emit quand le client transmet l'avancement du fragment en cours
+     * @param progress avancement entre 0 et 99
+     */
+    void sig_calculProgress(int progress);
+
+    /**
+     * @brief Emit quand le client transmet un point de reprise du fragment en cours
+     * @param checkpoint paramètres à substituer à ceux du fragment pour reprendre le calcul
+     */
+    void sig_calculCheckpoint(const QJsonObject &checkpoint);
+
+    /**
+     * @brief Emit quand un fragment a été calculé avec succès, avant la transmission du
+     *        résultat et alors que le client porte encore le fragment
+     * @param client le client qui a calculé le fragment
+     */
+    void sig_calculSucceeded(ClientSession *client);
+
+    /**
+     * @brief Emit quand le bail du fragment du client expire, avant la fermeture de sa session
+     * @param client le client qui porte encore le fragment
+     */
+    void sig_leaseExpired(ClientSession *client);
+
     /**
      * @brief Emit quand le client s'est déconnecté
      * @param client pointeur vers ce client
@@ -126,6 +168,20 @@ private:
      */
     void send(ReqType reqtype, const QByteArray &content = QByteArray());
 
+    /**
+     * @brief Envoie un plugin au client. Par morceaux, l'envoi se poursuit au rythme de
+     *        l'écriture du socket sans bloquer les autres sessions
+     * @param plugin le contenu du plugin
+     * @param chunked vrai si le client accepte le transfert par morceaux
+     * @param compress vrai si le client accepte les morceaux compressés
+     */
+    void sendPlugin(const MappedPluginPtr &plugin, bool chunked, bool compress);
+
+    /**
+     * @brief Interrompt l'envoi du plugin en cours s'il y en a un
+     */
+    void cancelPluginTransfer();
+
     /**
      * @brief Effectue la transition de l'automate avec la liste des transitions données
      */
@@ -160,6 +216,17 @@ private slots:
      */
     void slot_processReadyRead();
 
+    /**
+     * @brief Envoie les morceaux suivants du plugin tant que le tampon d'écriture le permet
+     */
+    void slot_sendPluginChunks();
+
+    /**
+     * @brief Demande au client d'arrêter son plugin puis ferme la session, le plugin n'ayant
+     *        donné aucune nouvelle pendant toute la durée du bail
+     */
+    void slot_leaseExpired();
+
 private:
     AbstractState *_disconnectedState;
     AbstractState *_currentState;
@@ -169,6 +236,11 @@ private:
     QSet<QString> _missingPlugins;
     QTcpSocket *_socket;
     msg_size_t _blockSize;
+    MappedPluginPtr _pluginTransfer;
+    int _pluginOffset;
+    bool _pluginCompress;
+    QTimer _leaseTimer;
+    QElapsedTimer _leaseClock;
 };
 
 inline const Fragment *ClientSession::GetFragment() const
@@ -176,4 +248,14 @@ inline const Fragment *ClientSession::GetFragment() const
     return _fragment;
 }
 
+inline qint64 ClientSession::GetCalculElapsed() const
+{
+    return _leaseClock.elapsed();
+}
+
+inline QHostAddress ClientSession::GetPeerAddress() const
+{
+    return _socket->peerAddress();
+}
+
 #endif // CLIENT_SESSION_H
@@ -33,6 +33,12 @@ void AbstractState::ProcessDo(const QByteArray &content)
     _client->setCurrentStateAfterError("Do not handled");
 }
 
+void AbstractState::ProcessCheckpoint(const QByteArray &content)
+{
+    // comme PROGRESS, un point de reprise peut croiser un changement d'état : il est ignoré
+    Q_UNUSED(content)
+}
+
 void AbstractState::ProcessDone(const QByteArray &content)
 {
     Q_UNUSED(content)
@@ -44,6 +50,12 @@ void AbstractState::ProcessHello()
     _client->setCurrentStateAfterError("Hello not handled");
 }
 
+void AbstractState::ProcessProgress(const QByteArray &content)
+{
+    // un avancement peut croiser un changement d'état (STOP, DONE) : il est simplement ignoré
+    Q_UNUSED(content)
+}
+
 void AbstractState::ProcessReady(const QByteArray &content)
 {
     Q_UNUSED(content)
@@ -46,6 +46,11 @@ public:
      */
     virtual void ProcessDo(const QByteArray &content);
 
+    /**
+     * @brief Effectue la commande CHECKPOINT
+     */
+    virtual void ProcessCheckpoint(const QByteArray &content);
+
     /**
      * @brief Effectue la commande DONE
      */
@@ -56,6 +61,11 @@ public:
      */
     virtual void ProcessHello();
 
+    /**
+     * @brief Effectue la commande PROGRESS
+     */
+    virtual void ProcessProgress(const QByteArray &content);
+
     /**
      * @brief Effectue la commande READY
      */
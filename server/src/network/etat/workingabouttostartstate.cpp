@@ -3,6 +3,8 @@
 #include "src/network/clientsession.h"
 #include "src/plugins/pluginmanager.h"
 
+#include <QJsonArray>
+
 WorkingAboutToStartState::WorkingAboutToStartState(ClientSession *parent) : AbstractState(parent)
 {
     setObjectName("WorkingAboutToStartState");
@@ -15,9 +17,8 @@ WorkingAboutToStartState::~WorkingAboutToStartState()
 void WorkingAboutToStartState::ProcessUnable(const QByteArray &content)
 {
     // parsing du json reçu
-    QJsonDocument doc;
     QJsonParseError error;
-    doc.fromJson(content, &error);
+    QJsonDocument doc = QJsonDocument::fromJson(content, &error);
     QJsonObject object = doc.object();
     // vérification de l'intégrité de l'objet JSON
     if(!object.contains("id") ||
@@ -30,14 +31,15 @@ void WorkingAboutToStartState::ProcessUnable(const QByteArray &content)
     }
     else if (object.value("id").toString() == _client->GetId().toString())
     {
-        const QByteArray * data = PluginManager::getInstance().GetPluginData(
+        MappedPluginPtr data = PluginManager::getInstance().GetPluginData(
                     object.value("arch").toString(),
                     object.value("os").toString(),
                     _client->GetFragment()->GetBin());
-        if(data != NULL)
+        if(data)
         {
-            _client->send(BIN, *data);
-            delete data;
+            _client->sendPlugin(data,
+                                object.value(BIN_KEY_CHUNKED).toBool(),
+                                object.value(BIN_KEY_ENCODINGS).toArray().contains(QJsonValue(BIN_ENCODING_QCOMPRESS)));
         }
         else
         {
@@ -21,11 +21,24 @@ void WorkingState::ProcessAbort(const QByteArray &content)
     }
 }
 
+void WorkingState::ProcessCheckpoint(const QByteArray &content)
+{
+    if (content.startsWith(_client->GetId().toString().toUtf8()))
+    {
+        QJsonParseError jsonError;
+        QJsonDocument doc = QJsonDocument::fromJson(content.mid(_client->GetId().toString().size()), &jsonError);
+        if (jsonError.error != QJsonParseError::NoError || !doc.isObject())
+            LOG_ERROR("An error occured while parsing fragment checkpoint json block.");
+        else
+            emit _client->sig_calculCheckpoint(doc.object());
+    }
+}
+
 void WorkingState::ProcessDone(const QByteArray &content)
 {
     if (content.startsWith(_client->GetId().toString().toUtf8()))
     {
-        LOG_DEBUG(QString("Computed received json=%1").arg(QString(content.mid(_client->GetId().toString().size()))));
+        LOG_DEBUG(QString("Computed received %1 bytes.").arg(content.size() - _client->GetId().toString().size()));
 
         QJsonParseError jsonError;
         QJsonDocument doc = QJsonDocument::fromJson(content.mid(_client->GetId().toString().size()), &jsonError);
@@ -36,6 +49,7 @@ void WorkingState::ProcessDone(const QByteArray &content)
         }
         else
         {
+            emit _client->sig_calculSucceeded(_client);
             emit _client->sig_calculDone(doc.object());
             _client->resetCurrentFragment();
             _client->setCurrentStateAfterSuccess();
@@ -43,6 +57,18 @@ void WorkingState::ProcessDone(const QByteArray &content)
     }
 }
 
+void WorkingState::ProcessProgress(const QByteArray &content)
+{
+    if (content.startsWith(_client->GetId().toString().toUtf8()))
+    {
+        bool ok;
+        int progress = content.mid(_client->GetId().toString().size()).toInt(&ok);
+        // 100 est réservé au DONE qui porte le résultat
+        if (ok)
+            emit _client->sig_calculProgress(qBound(0, progress, 99));
+    }
+}
+
 void WorkingState::ProcessStop()
 {
     _client->send(STOP);
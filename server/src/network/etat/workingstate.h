@@ -27,11 +27,21 @@ public:
      */
     virtual void ProcessAbort(const QByteArray &content) override;
 
+    /**
+     * @brief Effectue la commande CHECKPOINT
+     */
+    virtual void ProcessCheckpoint(const QByteArray &content) override;
+
     /**
      * @brief Effectue la commande DONE
      */
     virtual void ProcessDone(const QByteArray &content) override;
 
+    /**
+     * @brief Effectue la commande PROGRESS
+     */
+    virtual void ProcessProgress(const QByteArray &content) override;
+
     /**
      * @brief Effectue la commande STOP
      */
@@ -2,8 +2,18 @@
 #include "src/utils/logger.h"
 
 #include <QThread>
+#include <climits>
 
-NetworkManager::NetworkManager()
+#define LEASE_DEFAULT   (10 * 60 * 1000)    // ms, bail d'un fragment dont la durée est inconnue
+#define LEASE_MIN       (60 * 1000)         // ms, laisse le temps au plugin d'écrire un PROGRESS
+#define LEASE_MARGIN    3                   // bail = LEASE_MARGIN x durée attendue
+#define LEASE_BACKOFF_MAX 5                 // un bail double au plus 5 fois s'il expire
+#define BACKUP_THRESHOLD_DEFAULT 90         // %, avancement d'un calcul à partir duquel ses fragments sont dupliqués
+
+NetworkManager::NetworkManager() :
+    _backupThreshold(BACKUP_THRESHOLD_DEFAULT),
+    _backupCount(0),
+    _backupWinCount(0)
 {
 }
 
@@ -27,6 +37,34 @@ int NetworkManager::WorkingClientCount() const
     return _fragmentsPlace.count();
 }
 
+void NetworkManager::RemoveWaitingFragments(const Calculation *calculation)
+{
+    QQueue<const Fragment *>::iterator it = _waitingFragments.begin();
+    while (it != _waitingFragments.end())
+    {
+        if ((*it)->GetCalculation() == calculation)
+            it = _waitingFragments.erase(it);
+        else
+            it++;
+    }
+    emit sig_waitingCalculationCountUpdated(_waitingFragments.count());
+}
+
+void NetworkManager::SetBackupThreshold(int percent)
+{
+    _backupThreshold = qBound(0, percent, 100);
+}
+
+int NetworkManager::BackupCount() const
+{
+    return _backupCount;
+}
+
+int NetworkManager::BackupWinCount() const
+{
+    return _backupWinCount;
+}
+
 NetworkManager &NetworkManager::getInstance()
 {
     static NetworkManager instance;
@@ -37,20 +75,18 @@ void NetworkManager::slot_addAvailableClient(ClientSession *client)
 {
     if (client == NULL)
         return;
-    if (_unavailableClients.remove(client) && client->GetFragment() != NULL)
-    {
-        _fragmentsPlace.remove(client->GetFragment()->GetId());
+    // le fragment du client a déjà été libéré quand le client redevient prêt
+    if (_unavailableClients.remove(client) && !release(client).isNull())
         emit sig_workingClientCountUpdated(_fragmentsPlace.count());
-    }
 
     emit sig_availableClientCountUpdated(_availableClients.count());
 
     LOG_DEBUG("Adding available client");
     _availableClients.insert(client);
-    if (_waitingFragments.size() > 0)
+    if (!startWaiting(client))
     {
-        Slot_startCalcul(_waitingFragments.dequeue());
-        emit sig_waitingCalculationCountUpdated(_waitingFragments.count());
+        while (startBackup())
+            ;
     }
 }
 
@@ -63,19 +99,17 @@ void NetworkManager::slot_addUnavailableClient(ClientSession *client)
     if (_availableClients.remove(client))
         found = true;
     if (_unavailableClients.remove(client))
-    {
         found = true;
-        _fragmentsPlace.remove(client->GetFragment()->GetId());
-        emit sig_workingClientCountUpdated(_fragmentsPlace.count());
-    }
     _unavailableClients.insert(client);
     if (!found)
     {
         emit sig_clientCountUpdated(ClientCount());
-        connect(client, &ClientSession::sig_unableToCalculate, this, &NetworkManager::Slot_startCalcul);
+        connect(client, &ClientSession::sig_unableToCalculate, this, &NetworkManager::slot_unableToCalculate);
         connect(client, &ClientSession::sig_ready, this, &NetworkManager::slot_addAvailableClient);
         connect(client, &ClientSession::sig_working, this, &NetworkManager::slot_addUnavailableClient);
         connect(client, &ClientSession::sig_disconnected, this, &NetworkManager::slot_deleteClient);
+        connect(client, &ClientSession::sig_calculSucceeded, this, &NetworkManager::slot_calculSucceeded);
+        connect(client, &ClientSession::sig_leaseExpired, this, &NetworkManager::slot_leaseExpired);
     }
 
     emit sig_availableClientCountUpdated(_availableClients.count());
@@ -86,17 +120,27 @@ void NetworkManager::slot_deleteClient(ClientSession *client)
     LOG_INFO("Client "+client->GetId().toString()+" has disconnected!");
 
     _availableClients.remove(client);
-    if (_unavailableClients.remove(client) && client->GetFragment() != NULL)
+    if (_unavailableClients.remove(client))
     {
-        _fragmentsPlace.remove(client->GetFragment()->GetId());
-
-        LOG_DEBUG("Fragment is getting reaffected.");
-        Slot_startCalcul(client->GetFragment());
-
-        emit sig_workingClientCountUpdated(_fragmentsPlace.count());
+        QUuid fragmentId = release(client);
+        // le fragment n'est réattribué que si aucune autre copie n'est en cours
+        if (client->GetFragment() != NULL && !_fragmentsPlace.contains(client->GetFragment()->GetId()))
+        {
+            LOG_INFO("Fragment is getting reaffected.");
+            Slot_startCalcul(client->GetFragment());
+        }
+        if (!fragmentId.isNull())
+            emit sig_workingClientCountUpdated(_fragmentsPlace.count());
     }
     client->deleteLater();
 
+    // les fragments écartés d'une machine peuvent lui revenir si elle reste seule
+    foreach (ClientSession *available, _availableClients)
+    {
+        if (_availableClients.contains(available))
+            startWaiting(available);
+    }
+
     emit sig_clientCountUpdated(ClientCount());
     emit sig_availableClientCountUpdated(_availableClients.count());
 }
@@ -114,25 +158,202 @@ void NetworkManager::Slot_init()
 
 void NetworkManager::Slot_startCalcul(const Fragment *fragment)
 {
-    QSet<ClientSession *>::iterator it = _availableClients.begin();
-    bool add = false;
-    if (it == _availableClients.end())
-        add = true;
-    else
+    ClientSession *client = NULL;
+    foreach (ClientSession *candidate, _availableClients)
     {
-        _availableClients.remove(*it);
-        _fragmentsPlace.insert(fragment->GetId(), *it);
-        _unavailableClients.insert(*it);
-        add = !(*it)->StartCalcul(fragment);
-
-        emit sig_workingClientCountUpdated(_fragmentsPlace.count());
-        emit sig_availableClientCountUpdated(_availableClients.count());
+        if (mayCalculate(fragment, candidate))
+        {
+            client = candidate;
+            break;
+        }
     }
 
-    if (add)
+    if (client == NULL || !dispatch(fragment, client))
     {
         LOG_INFO("Mise en attente du calcul.");
         _waitingFragments.enqueue(fragment);
         emit sig_waitingCalculationCountUpdated(_waitingFragments.count());
     }
 }
+
+void NetworkManager::slot_calculSucceeded(ClientSession *client)
+{
+    const Fragment *fragment = client->GetFragment();
+    if (fragment == NULL)
+        return;
+
+    // moyenne glissante, les derniers fragments pèsent plus que les premiers
+    qint64 msecs = client->GetCalculElapsed();
+    qint64 average = _durations.value(fragment->GetBin(), -1);
+    _durations.insert(fragment->GetBin(), average < 0 ? msecs : (3 * average + msecs) / 4);
+
+    // le premier résultat l'emporte : le fragment quitte la répartition avant l'arrêt des
+    // autres copies, les clients ainsi libérés ne doivent pas le dupliquer à nouveau
+    QUuid fragmentId = fragment->GetId();
+    _expiredLeases.remove(fragmentId);
+    _expiredHosts.remove(fragmentId);
+    QList<ClientSession *> copies = _fragmentsPlace.values(fragmentId);
+    _fragmentsPlace.remove(fragmentId);
+    if (_backups.contains(fragmentId))
+    {
+        if (_backups.take(fragmentId) == client)
+        {
+            _backupWinCount++;
+            LOG_INFO(QString("Backup copy of fragment %1 finished first (%2/%3 backups useful).")
+                     .arg(fragmentId.toString()).arg(_backupWinCount).arg(_backupCount));
+        }
+    }
+    foreach (ClientSession *copy, copies)
+    {
+        if (copy != client)
+            copy->Slot_stopCalcul();
+    }
+    emit sig_workingClientCountUpdated(_fragmentsPlace.count());
+}
+
+void NetworkManager::slot_leaseExpired(ClientSession *client)
+{
+    // un fragment plus long que prévu qui ne donne pas d'avancement finit par tenir dans son bail,
+    // mais il est d'abord confié à une autre machine que celle où son plugin s'est bloqué
+    if (client->GetFragment() == NULL)
+        return;
+    QUuid fragmentId = client->GetFragment()->GetId();
+    _expiredLeases[fragmentId]++;
+    _expiredHosts.insert(fragmentId, client->GetPeerAddress());
+}
+
+void NetworkManager::slot_unableToCalculate(const Fragment *fragment)
+{
+    // la place du client qui refuse le fragment n'est libérée qu'à son retour à l'état prêt
+    if (_fragmentsPlace.count(fragment->GetId()) > 1)
+        return;
+    Slot_startCalcul(fragment);
+}
+
+int NetworkManager::leaseFor(const Fragment *fragment) const
+{
+    qint64 expected = fragment->GetEstimate();
+    if (expected <= 0)
+        expected = _durations.value(fragment->GetBin(), 0);
+    qint64 lease = expected > 0 ? qMax((qint64)LEASE_MIN, expected * LEASE_MARGIN) : LEASE_DEFAULT;
+    lease <<= qMin(_expiredLeases.value(fragment->GetId(), 0), LEASE_BACKOFF_MAX);
+    return (int)qMin(lease, (qint64)INT_MAX);
+}
+
+bool NetworkManager::dispatch(const Fragment *fragment, ClientSession *client)
+{
+    _availableClients.remove(client);
+    _fragmentsPlace.insert(fragment->GetId(), client);
+    _unavailableClients.insert(client);
+    bool started = client->StartCalcul(fragment, leaseFor(fragment));
+    if (!started)
+    {
+        _fragmentsPlace.remove(fragment->GetId(), client);
+        _unavailableClients.remove(client);
+        _availableClients.insert(client);
+    }
+
+    emit sig_workingClientCountUpdated(_fragmentsPlace.count());
+    emit sig_availableClientCountUpdated(_availableClients.count());
+    return started;
+}
+
+bool NetworkManager::mayCalculate(const Fragment *fragment, ClientSession *client) const
+{
+    QHostAddress expired = _expiredHosts.value(fragment->GetId());
+    if (expired.isNull() || client->GetPeerAddress() != expired)
+        return true;
+    foreach (ClientSession *other, _availableClients + _unavailableClients)
+    {
+        if (other->GetPeerAddress() != expired)
+            return false;
+    }
+    return true;
+}
+
+bool NetworkManager::startWaiting(ClientSession *client)
+{
+    for (int i = 0; i < _waitingFragments.size(); i++)
+    {
+        const Fragment *fragment = _waitingFragments.at(i);
+        if (!mayCalculate(fragment, client))
+            continue;
+        _waitingFragments.removeAt(i);
+        emit sig_waitingCalculationCountUpdated(_waitingFragments.count());
+        Slot_startCalcul(fragment);
+        return true;
+    }
+    return false;
+}
+
+QUuid NetworkManager::release(ClientSession *client)
+{
+    QMultiMap<QUuid, ClientSession *>::iterator it = _fragmentsPlace.begin();
+    while (it != _fragmentsPlace.end())
+    {
+        if (it.value() != client)
+        {
+            it++;
+            continue;
+        }
+        QUuid fragmentId = it.key();
+        _fragmentsPlace.erase(it);
+        // la copie de secours est oubliée quand elle s'arrête ou quand plus aucune copie ne tourne
+        if (_backups.value(fragmentId) == client || !_fragmentsPlace.contains(fragmentId))
+            _backups.remove(fragmentId);
+        return fragmentId;
+    }
+    return QUuid();
+}
+
+bool NetworkManager::startBackup()
+{
+    if (_availableClients.isEmpty() || !_waitingFragments.isEmpty() || _fragmentsPlace.isEmpty())
+        return false;
+
+    // fragments restant à calculer par calcul, la file d'attente étant vide
+    QHash<const Calculation *, int> outstanding;
+    foreach (const QUuid &fragmentId, _fragmentsPlace.uniqueKeys())
+    {
+        const Fragment *fragment = _fragmentsPlace.value(fragmentId)->GetFragment();
+        if (fragment != NULL)
+            outstanding[fragment->GetCalculation()]++;
+    }
+
+    // le fragment sans copie dont la fin est la plus lointaine, parmi les calculs avancés : temps
+    // restant extrapolé de l'avancement transmis par le client, sinon durée écoulée
+    ClientSession *backup = *_availableClients.begin();
+    const Fragment *slowest = NULL;
+    qint64 slowestElapsed = -1;
+    qint64 slowestRemaining = -1;
+    foreach (const QUuid &fragmentId, _fragmentsPlace.uniqueKeys())
+    {
+        if (_fragmentsPlace.count(fragmentId) > 1)
+            continue;
+        ClientSession *holder = _fragmentsPlace.value(fragmentId);
+        const Fragment *fragment = holder->GetFragment();
+        if (fragment == NULL || !mayCalculate(fragment, backup))
+            continue;
+        const Calculation *calculation = fragment->GetCalculation();
+        if (!calculation->IsSplitDone() ||
+            outstanding.value(calculation) * 100 > calculation->GetFragmentCount() * (100 - _backupThreshold))
+            continue;
+        qint64 elapsed = holder->GetCalculElapsed();
+        int progress = qBound(0, fragment->GetProgress(), 100);
+        qint64 remaining = progress > 0 ? elapsed * (100 - progress) / progress : elapsed;
+        if (remaining > slowestRemaining)
+        {
+            slowest = fragment;
+            slowestElapsed = elapsed;
+            slowestRemaining = remaining;
+        }
+    }
+    if (slowest == NULL || !dispatch(slowest, backup))
+        return false;
+
+    _backups.insert(slowest->GetId(), backup);
+    _backupCount++;
+    LOG_INFO(QString("Backup copy of fragment %1 started after %2 ms, about %3 ms left.")
+             .arg(slowest->GetId().toString()).arg(slowestElapsed).arg(slowestRemaining));
+    return true;
+}
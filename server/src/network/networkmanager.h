@@ -2,6 +2,7 @@
 #define NETWORK_MANAGER_H
 
 #include <QObject>
+#include <QHash>
 #include <QMap>
 #include <QQueue>
 #include <QJsonObject>
@@ -41,6 +42,29 @@ public:
      */
     int WorkingClientCount() const;
 
+    /**
+     * @brief Retire de la file d'attente les fragments du calcul donné
+     * @param calculation le calcul dont les fragments ne doivent plus être distribués
+     */
+    void RemoveWaitingFragments(const Calculation *calculation);
+
+    /**
+     * @brief Fixe l'avancement à partir duquel les fragments les plus lents d'un calcul
+     *        sont dupliqués sur les clients inoccupés
+     * @param percent pourcentage de fragments calculés, 100 désactive les copies de secours
+     */
+    void SetBackupThreshold(int percent);
+
+    /**
+     * @brief Retourne le nombre de copies de secours lancées
+     */
+    int BackupCount() const;
+
+    /**
+     * @brief Retourne le nombre de copies de secours qui ont terminé avant l'original
+     */
+    int BackupWinCount() const;
+
 public slots:
     /**
      * Initialise le manager et démarre les serveurs UDP et TCP
@@ -122,13 +146,79 @@ private slots:
      */
     void slot_deleteClient(ClientSession *client);
 
+    /**
+     * @brief Met à jour la durée moyenne de calcul des fragments du plugin et arrête
+     *        les autres copies du fragment calculé par le client
+     */
+    void slot_calculSucceeded(ClientSession *client);
+
+    /**
+     * @brief Réattribue un fragment que le client ne peut pas calculer, sauf si une autre
+     *        copie est déjà en cours
+     */
+    void slot_unableToCalculate(const Fragment *fragment);
+
+    /**
+     * @brief Compte les bails expirés d'un fragment, le suivant sera plus long, et retient
+     *        la machine sur laquelle il a expiré
+     */
+    void slot_leaseExpired(ClientSession *client);
+
+private:
+    /**
+     * @brief Calcule la durée du bail d'un fragment : estimation du plugin, sinon durée moyenne
+     *        des fragments précédents du même plugin, avec une marge, doublée à chaque bail
+     *        déjà expiré pour ce fragment
+     * @return durée en millisecondes
+     */
+    int leaseFor(const Fragment *fragment) const;
+
+    /**
+     * @brief Confie un fragment à un client disponible
+     * @return faux si le client ne peut pas le calculer, il reste alors disponible
+     */
+    bool dispatch(const Fragment *fragment, ClientSession *client);
+
+    /**
+     * @brief Indique si le fragment peut être confié au client : un fragment dont le bail a
+     *        expiré ne retourne sur la même machine que si aucune autre n'est connectée
+     */
+    bool mayCalculate(const Fragment *fragment, ClientSession *client) const;
+
+    /**
+     * @brief Confie au client, ou à un autre client disponible, le premier fragment en
+     *        attente qu'il peut calculer
+     * @return faux si aucun fragment en attente ne peut lui être confié
+     */
+    bool startWaiting(ClientSession *client);
+
+    /**
+     * @brief Libère la place occupée par le client dans la répartition des fragments
+     * @return l'id du fragment que le client calculait, nul s'il n'en calculait pas
+     */
+    QUuid release(ClientSession *client);
+
+    /**
+     * @brief Duplique sur un client disponible le fragment dont le temps restant estimé
+     *        est le plus long, parmi ceux des calculs qui ont dépassé le seuil de copie
+     * @return faux si aucune copie n'a été lancée
+     */
+    bool startBackup();
+
 private:
     QSet<ClientSession *> _availableClients;
-    QMap<QUuid, ClientSession *> _fragmentsPlace;
+    QMultiMap<QUuid, ClientSession *> _fragmentsPlace;
     TCPServer *_TCPServer;
     UDPServer *_UDPServer;
     QSet<ClientSession *> _unavailableClients;
     QQueue<const Fragment *> _waitingFragments;
+    QHash<QString, qint64> _durations;
+    QHash<QUuid, int> _expiredLeases;
+    QHash<QUuid, QHostAddress> _expiredHosts;
+    QHash<QUuid, ClientSession *> _backups;
+    int _backupThreshold;
+    int _backupCount;
+    int _backupWinCount;
 
     Q_DISABLE_COPY(NetworkManager)
 };
@@ -0,0 +1,91 @@
+#include "libraryplugin.h"
+#include "src/calculation/specs.h"
+
+#include <QFile>
+#include <cstdio>
+
+LibraryPlugin * LibraryPlugin::Load(const QString &path, QString &error)
+{
+    LibraryPlugin * plugin = new LibraryPlugin(path);
+    if(!plugin->_library.load())
+    {   error = plugin->_library.errorString();
+    }
+    else
+    {   CsPluginAbiVersion version = (CsPluginAbiVersion)plugin->_library.resolve(CS_PLUGIN_SYM_VERSION);
+        plugin->_free = (CsPluginFree)plugin->_library.resolve(CS_PLUGIN_SYM_FREE);
+        if(!version || !plugin->_free)
+        {   error = QString("Missing '%1' or '%2' symbol in plugin library '%3' !")
+                    .arg(CS_PLUGIN_SYM_VERSION).arg(CS_PLUGIN_SYM_FREE).arg(path);
+        }
+        else if(version() != CS_PLUGIN_ABI_VERSION)
+        {   error = QString("Plugin library '%1' implements ABI version %2, expected %3 !")
+                    .arg(path).arg(version()).arg(CS_PLUGIN_ABI_VERSION);
+        }
+        else
+        {   // -- les opérations non exportées sont refusées à l'appel
+            plugin->_entries.insert(CS_OP_SPLIT, (CsPluginEntry)plugin->_library.resolve(CS_PLUGIN_SYM_SPLIT));
+            plugin->_entries.insert(CS_OP_CALC,  (CsPluginEntry)plugin->_library.resolve(CS_PLUGIN_SYM_CALC));
+            plugin->_entries.insert(CS_OP_JOIN,  (CsPluginEntry)plugin->_library.resolve(CS_PLUGIN_SYM_JOIN));
+            plugin->_entries.insert(CS_OP_PARAM, (CsPluginEntry)plugin->_library.resolve(CS_PLUGIN_SYM_PARAM));
+        }
+    }
+    if(!error.isEmpty())
+    {   delete plugin;
+        plugin = NULL;
+    }
+    return plugin;
+}
+
+bool LibraryPlugin::Call(const QByteArray &op, const QByteArray &in, QByteArray &out) const
+{
+    CsPluginEntry entry = _entries.value(op, NULL);
+    if(!entry)
+    {   out = QString("Unsupported operation : '%1' !").arg(QString(op)).toUtf8();
+        return false;
+    }
+    char * buffer = NULL;
+    size_t size = 0;
+    int status = entry(in.constData(), (size_t)in.size(), &buffer, &size);
+    out = QByteArray(buffer, (int)size);
+    if(buffer)
+    {   _free(buffer);
+    }
+    return status == 0;
+}
+
+int LibraryPlugin::Host(const QString &path)
+{
+    // -- lecture de la requête : opération, JSON, puis EOF
+    QFile in;
+    if(!in.open(stdin, QIODevice::ReadOnly))
+    {   fprintf(stderr, "Can't read standard input !\n");
+        return 1;
+    }
+    QByteArray op = in.readLine().trimmed();
+    QByteArray json;
+    forever
+    {   QByteArray line = in.readLine();
+        if(line.isEmpty() || line.trimmed() == CS_EOF) break;
+        json.append(line);
+    }
+    // -- exécution de l'opération
+    QString error;
+    LibraryPlugin * plugin = Load(path, error);
+    if(!plugin)
+    {   fprintf(stderr, "%s\n", error.toUtf8().constData());
+        return 1;
+    }
+    QByteArray out;
+    bool ok = plugin->Call(op, json.trimmed(), out);
+    fwrite(out.constData(), 1, out.size(), ok ? stdout : stderr);
+    fflush(ok ? stdout : stderr);
+    delete plugin;
+    return ok ? 0 : 1;
+}
+
+LibraryPlugin::LibraryPlugin(const QString &path) :
+    _library(path),
+    _free(NULL),
+    _entries()
+{
+}
@@ -0,0 +1,89 @@
+#include "plugincache.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+
+MappedPluginPtr MappedPlugin::Map(const QString &path)
+{
+    MappedPluginPtr plugin(new MappedPlugin(path));
+    if(!plugin->_file.open(QIODevice::ReadOnly))
+    {   return MappedPluginPtr();
+    }
+    QFileInfo info(plugin->_file);
+    plugin->_size = info.size();
+    plugin->_modified = info.lastModified();
+    // -- un fichier vide ne peut pas être projeté
+    if(plugin->_size > 0)
+    {   plugin->_map = plugin->_file.map(0, plugin->_size);
+        if(!plugin->_map)
+        {   return MappedPluginPtr();
+        }
+        plugin->_data = QByteArray::fromRawData((const char *)plugin->_map, (int)plugin->_size);
+    }
+    return plugin;
+}
+
+MappedPlugin::~MappedPlugin()
+{
+    if(_map)
+    {   _file.unmap(_map);
+    }
+}
+
+bool MappedPlugin::IsStale() const
+{
+    QFileInfo info(_file.fileName());
+    return !info.exists() || info.size() != _size || info.lastModified() != _modified;
+}
+
+MappedPlugin::MappedPlugin(const QString &path) :
+    _file(path),
+    _map(NULL),
+    _size(0),
+    _modified(),
+    _data()
+{
+}
+
+PluginCache::PluginCache() :
+    _entries(),
+    _mutex()
+{
+}
+
+MappedPluginPtr PluginCache::Get(const QString &path, const QByteArray &hash)
+{
+    QMutexLocker locker(&_mutex);
+    MappedPluginPtr plugin = _entries.value(hash);
+    // -- le fichier a pu être réécrit avant que le registre ne s'en aperçoive
+    if(!plugin || plugin->IsStale())
+    {   plugin = MappedPlugin::Map(path);
+        if(plugin)
+        {   _entries.insert(hash, plugin);
+        }
+        else
+        {   _entries.remove(hash);
+        }
+    }
+    return plugin;
+}
+
+void PluginCache::Retain(const QSet<QByteArray> &hashes)
+{
+    QMutexLocker locker(&_mutex);
+    QHash<QByteArray, MappedPluginPtr>::iterator it = _entries.begin();
+    while(it != _entries.end())
+    {   if(hashes.contains(it.key()))
+        {   ++it;
+        }
+        else
+        {   it = _entries.erase(it);
+        }
+    }
+}
+
+void PluginCache::Clear()
+{
+    QMutexLocker locker(&_mutex);
+    _entries.clear();
+}
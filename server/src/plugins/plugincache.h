@@ -0,0 +1,84 @@
+#ifndef PLUGINCACHE_H
+#define PLUGINCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+
+/**
+ * @brief Cette classe représente le contenu d'un plugin projeté en mémoire, en lecture seule.
+ *      La projection est libérée avec la dernière référence, même si le plugin a été remplacé
+ */
+class MappedPlugin
+{
+public:
+    /**
+     * @brief Projette un fichier en mémoire
+     * @return NULL si le fichier ne peut pas être projeté
+     */
+    static QSharedPointer<MappedPlugin> Map(const QString & path);
+    ~MappedPlugin();
+    /**
+     * @brief Retourne le contenu du plugin, sans copie
+     * @warning le tableau ne doit pas survivre à l'instance
+     */
+    inline const QByteArray & GetData() const { return _data; }
+    /**
+     * @brief Indique si le fichier a changé depuis sa projection
+     */
+    bool IsStale() const;
+
+private:
+    MappedPlugin(const QString & path);
+    Q_DISABLE_COPY(MappedPlugin)
+
+    QFile _file;
+    uchar * _map;
+    qint64 _size;
+    QDateTime _modified;
+    QByteArray _data;
+};
+
+typedef QSharedPointer<MappedPlugin> MappedPluginPtr;
+
+/**
+ * @brief Cette classe partage le contenu des plugins entre les sessions clientes : chaque
+ *      contenu, identifié par son empreinte, est projeté une seule fois
+ */
+class PluginCache
+{
+public:
+    PluginCache();
+    /**
+     * @brief Retourne le contenu d'un plugin, projeté au premier appel
+     * @param path
+     *      Chemin absolu du plugin
+     * @param hash
+     *      Empreinte du contenu du plugin
+     * @return NULL si le plugin ne peut pas être lu
+     */
+    MappedPluginPtr Get(const QString & path, const QByteArray & hash);
+    /**
+     * @brief Oublie les contenus qui ne correspondent plus à aucun plugin, les sessions qui
+     *      les utilisent encore les conservent jusqu'à la fin de leur envoi
+     * @param hashes
+     *      Empreintes des plugins actuels
+     */
+    void Retain(const QSet<QByteArray> & hashes);
+    /**
+     * @brief Oublie le contenu de tous les plugins
+     */
+    void Clear();
+
+private:
+    Q_DISABLE_COPY(PluginCache)
+
+    QHash<QByteArray, MappedPluginPtr> _entries;
+    QMutex _mutex;
+};
+
+#endif // PLUGINCACHE_H
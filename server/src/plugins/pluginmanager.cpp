@@ -5,10 +5,14 @@
 
 #include <QCoreApplication>
 #include <QFile>
+#include <QThread>
+#include <QThreadPool>
 
 #define ENTRY_LIST_FILTER   QDir::Files
 #define ENTRY_LIST_SORT     QDir::Name
 #define ENTRY_LIST()        _plugins_dir.entryList(ENTRY_LIST_FILTER, ENTRY_LIST_SORT)
+#define WORKER_HELLO_TIMEOUT 5000 // ms
+#define MAX_WAITING_FRAGMENTS 1000 // au-delà, les fragmentations en flux sont suspendues
 
 PluginManager PluginManager::_instance;
 
@@ -26,27 +30,38 @@ bool PluginManager::Init()
         else {ok = true;}
     }
     else {ok = true;}
-    if(ok){ LOG_INFO("Plugin dir found !"); }
+    if(ok)
+    {   LOG_INFO("Plugin dir found !");
+        // -- le répertoire est lu une fois, puis surveillé
+        _registry = new PluginRegistry(this);
+        connect(_registry, SIGNAL(sig_pluginUpdated(QString)), SLOT(slot_pluginChanged(QString)));
+        connect(_registry, SIGNAL(sig_pluginRemoved(QString)), SLOT(slot_pluginChanged(QString)));
+        _registry->Init(_plugins_dir);
+    }
     return ok;
 }
 
 bool PluginManager::CheckPlugins() const
 {
-    bool ok = true;
+    // -- chaque plugin du répertoire doit avoir pu être lu et son empreinte calculée
+    bool ok = (_registry != NULL);
     foreach (QString plugin, ENTRY_LIST())
-    {   /// \todo do a MD5 checksum
+    {   if(!PluginExists(plugin))
+        {   LOG_ERROR(QString("Plugin '%1' is not readable !").arg(plugin));
+            ok = false;
+        }
     }
     return ok;
 }
 
 bool PluginManager::PluginExists(const QString &pluginName) const
 {
-    return ENTRY_LIST().contains(pluginName);
+    return _registry && _registry->Contains(pluginName);
 }
 
 QStringList PluginManager::GetPluginsList() const
 {
-    return ENTRY_LIST();
+    return _registry ? _registry->Names() : QStringList();
 }
 
 void PluginManager::Split(Calculation *calc)
@@ -59,14 +74,19 @@ void PluginManager::Join(Calculation *calc)
     startCalcProcess(calc, PluginProcess::JOIN);
 }
 
+void PluginManager::PartialJoin(Calculation *calc, int group)
+{   // -- lancement du processus associé
+    startCalcProcess(calc, PluginProcess::PARTIAL_JOIN, group);
+}
+
 void PluginManager::Ui(Calculation *calc)
 {   // -- lancement du processus associé
     startCalcProcess(calc, PluginProcess::UI);
 }
 
-const QByteArray *PluginManager::GetPluginData(const QString & arch, const QString & os, QString bin)
+MappedPluginPtr PluginManager::GetPluginData(const QString & arch, const QString & os, const QString & bin)
 {
-    QByteArray * data = NULL;
+    MappedPluginPtr data;
     bool loadData(false);
     switch (PluginProcess::DetectType(bin)) {
     case PluginProcess::JAR:
@@ -76,76 +96,300 @@ const QByteArray *PluginManager::GetPluginData(const QString & arch, const QStri
         loadData = true;
         break;
     case PluginProcess::BINARY:
+    case PluginProcess::LIBRARY:
         loadData = (arch == QHOST_ARCH && os == QHOST_OS);
         break;
     }
-    if(loadData && PluginExists(bin))
-    {   QFile f(bin.prepend('/').prepend(_plugins_dir.absolutePath()));
-        if(f.open(QIODevice::ReadOnly))
-        {
-            data = new QByteArray(f.readAll()); // bytearray must be delete by caller !
-            f.close();
-        }
+    PluginInfo info;
+    if(loadData && _registry && _registry->Info(bin, info))
+    {   // -- le contenu est projeté une fois et partagé par toutes les sessions
+        data = _cache.Get(_plugins_dir.absoluteFilePath(bin), info.hash);
     }
     return data;
 }
 
-void PluginManager::startCalcProcess(Calculation * calc, PluginProcess::CalculationOperation op)
+QString PluginManager::GetPluginHash(const QString &bin) const
+{
+    PluginInfo info;
+    if(_registry && _registry->Info(bin, info))
+    {   return QString(info.hash);
+    }
+    return QString();
+}
+
+void PluginManager::SetMaxJobs(int jobs)
+{
+    _maxJobs = qMax(jobs, 1);
+    _libraryPool.setMaxThreadCount(_maxJobs);
+    schedule();
+}
+
+void PluginManager::SetIsolatePlugins(bool isolate)
+{
+    _isolatePlugins = isolate;
+}
+
+void PluginManager::startCalcProcess(Calculation * calc, PluginProcess::CalculationOperation op, int group)
+{
+    // -- l'opération attend qu'une place se libère dans l'exécuteur
+    PendingOperation pending;
+    pending.calc = calc;
+    pending.op = op;
+    pending.group = group;
+    _pending.enqueue(pending);
+    schedule();
+}
+
+void PluginManager::schedule()
+{
+    while(_running < _maxJobs && !_pending.isEmpty())
+    {   PendingOperation pending = _pending.dequeue();
+        _running++;
+        launch(pending.calc, pending.op, pending.group);
+    }
+}
+
+void PluginManager::launch(Calculation *calc, PluginProcess::CalculationOperation op, int group)
 {
+    // -- un plugin bibliothèque est appelé dans le processus, sauf s'il doit en être isolé
+    if(!_isolatePlugins && PluginProcess::DetectType(calc->GetBin()) == PluginProcess::LIBRARY)
+    {   callLibrary(calc, op, group);
+        return;
+    }
+    // -- un plugin en mode worker traite la requête sans nouveau processus
+    PluginWorker * pw = (op == PluginProcess::UI ? NULL : worker(calc->GetBin()));
+    if(pw)
+    {   pw->Submit(calc, op, group);
+        return;
+    }
     // -- création d'un nouveau processus
-    PluginProcess * cp = new PluginProcess(_plugins_dir.absolutePath(), calc, op);
+    PluginProcess * cp = new PluginProcess(_plugins_dir.absolutePath(), calc, op, group);
+    connect(cp, SIGNAL(sig_done()), SLOT(slot_processDone()));
+    cp->SetPaused(_splitPaused);
     // -- ajout du process à la liste
     _processes.append(cp);
-    // -- lancement du processus
+    // -- lancement du processus, le résultat est transmis au calcul par le processus à sa fin
     if(!cp->Start())
     {   // on spécifie qu'il y a eu une erreur au niveau de l'execution (elle n'a pas eu lieu)
         calc->Crashed("Plugin type is script but no interpreter was found : process execution skipped !");
-        // interruption de la routine
-        return;
+        // la place est rendue après la boucle d'ordonnancement en cours
+        _processes.removeOne(cp);
+        cp->deleteLater();
+        QMetaObject::invokeMethod(this, "slot_operationDone", Qt::QueuedConnection);
     }
-    // -- on attend que le process se lance
-    cp->waitForStarted();
-    // -- write in process stdin
-    switch (op) {
-    case PluginProcess::SPLIT: // utile côté serveur
-        cp->write(CS_OP_SPLIT);
-        cp->write(CS_CRLF);
-        cp->write(calc->ToJson().toUtf8().data()); // ici calc est supposé être un ensemble de fragments
-        cp->write(CS_CRLF);
-        cp->write(CS_EOF);
-        cp->write(CS_CRLF);
-        break;
-    case PluginProcess::JOIN: // utile côté serveur
-        cp->write(CS_OP_JOIN);
-        cp->write(CS_CRLF);
-        cp->write(calc->FragmentsResultsToJson().toUtf8().data()); // ici calc est supposé contenir un ensemble de fragment
-        cp->write(CS_CRLF);
-        cp->write(CS_EOF);
-        cp->write(CS_CRLF);
-        break;
-    case PluginProcess::UI: // utile côté serveur
-        cp->write(CS_OP_PARAM);
-        cp->write(CS_CRLF);
-        cp->write(CS_EOF);
-        cp->write(CS_CRLF);
-        break;
-    default:
-        LOG_CRITICAL("Processus started without arguments : unhandled operation is the cause !");
-        break;
+}
+
+void PluginManager::callLibrary(Calculation *calc, PluginProcess::CalculationOperation op, int group)
+{
+    LibraryPlugin * plugin = _libraries.value(calc->GetBin(), NULL);
+    if(!plugin)
+    {   QString error;
+        plugin = LibraryPlugin::Load(_plugins_dir.absoluteFilePath(calc->GetBin()), error);
+        if(!plugin)
+        {   calc->Crashed(error);
+            // la place est rendue après la boucle d'ordonnancement en cours
+            QMetaObject::invokeMethod(this, "slot_operationDone", Qt::QueuedConnection);
+            return;
+        }
+        _libraries.insert(calc->GetBin(), plugin);
+    }
+    // -- la requête est construite ici, seul l'appel au plugin est fait dans le pool
+    QByteArray json;
+    const char * name = PluginProcess::Request(calc, op, group, json);
+    LibraryTask * task = new LibraryTask(plugin, name, json);
+    connect(task, SIGNAL(sig_done()), SLOT(slot_libraryDone()), Qt::QueuedConnection);
+    PendingOperation pending;
+    pending.calc = calc;
+    pending.op = op;
+    pending.group = group;
+    _libraryTasks.insert(task, pending);
+    _libraryPool.start(task);
+}
+
+PluginWorker * PluginManager::worker(const QString &bin)
+{
+    // -- l'hôte d'un plugin bibliothèque ne traite qu'une opération
+    if(_oneShotPlugins.contains(bin) || PluginProcess::DetectType(bin) == PluginProcess::LIBRARY)
+    {   return NULL;
+    }
+    // -- un worker libre de ce plugin, les workers morts sont retirés au passage
+    foreach (PluginWorker * pw, _workers.values(bin))
+    {   if(pw->state() == QProcess::NotRunning)
+        {   _workers.remove(bin, pw);
+            pw->deleteLater();
+        }
+        else if(!pw->IsBusy())
+        {   return pw;
+        }
+    }
+    // -- sinon un nouveau worker, le nombre d'opérations en cours borne celui des workers
+    QString command;
+    if(!PluginProcess::WorkerCommand(_plugins_dir.absolutePath(), bin, command))
+    {   return NULL;
+    }
+    PluginWorker * pw = new PluginWorker(bin, this);
+    connect(pw, SIGNAL(sig_ready()),   SLOT(slot_workerReady()));
+    connect(pw, SIGNAL(sig_done()),    SLOT(slot_operationDone()));
+    connect(pw, SIGNAL(sig_refused()), SLOT(slot_workerRefused()));
+    _workers.insert(bin, pw);
+    pw->Start(command, WORKER_HELLO_TIMEOUT);
+    return pw;
+}
+
+void PluginManager::Slot_waitingFragmentsUpdated(int count)
+{
+    bool paused = count >= MAX_WAITING_FRAGMENTS;
+    if(paused == _splitPaused) return;
+    LOG_DEBUG(QString("Streaming splits %1 (%2 waiting fragments).").arg(paused ? "paused" : "resumed").arg(count));
+    _splitPaused = paused;
+    foreach (PluginProcess * cp, _processes)
+    {   cp->SetPaused(paused);
+    }
+}
+
+void PluginManager::slot_processDone()
+{
+    PluginProcess * cp = qobject_cast<PluginProcess*>(sender());
+    if(cp && _processes.removeOne(cp))
+    {   cp->deleteLater();
+        slot_operationDone();
+    }
+}
+
+void PluginManager::slot_operationDone()
+{
+    _running--;
+    schedule();
+}
+
+void PluginManager::slot_libraryDone()
+{
+    LibraryTask * task = qobject_cast<LibraryTask*>(sender());
+    if(!task || !_libraryTasks.contains(task)) return;
+    PendingOperation done = _libraryTasks.take(task);
+    if(!task->IsOk())
+    {   done.calc->Crashed(task->GetOutput());
+    }
+    else
+    {   switch (done.op) {
+        case PluginProcess::SPLIT:
+            done.calc->Splitted(task->GetOutput());
+            break;
+        case PluginProcess::JOIN:
+            done.calc->Joined(task->GetOutput());
+            break;
+        case PluginProcess::PARTIAL_JOIN:
+            done.calc->PartialJoined(done.group, task->GetOutput());
+            break;
+        case PluginProcess::UI:
+            break; // là il ne se passe rien pour cette commande.
+        }
+    }
+    LibraryPlugin * plugin = const_cast<LibraryPlugin*>(task->GetPlugin());
+    if(_retiredLibraries.contains(plugin))
+    {   retireLibrary(plugin);
+    }
+    task->deleteLater();
+    slot_operationDone();
+}
+
+void PluginManager::slot_workerReady()
+{
+    PluginWorker * pw = qobject_cast<PluginWorker*>(sender());
+    if(pw && _registry)
+    {   _registry->DeclareCapability(pw->GetBin(), CAPABILITY_WORKER);
+    }
+}
+
+void PluginManager::slot_pluginChanged(const QString &name)
+{
+    // -- la nouvelle version sera de nouveau interrogée sur le mode worker
+    _oneShotPlugins.remove(name);
+    // -- les workers de l'ancienne version ne reçoivent plus de requête
+    foreach (PluginWorker * pw, _workers.values(name))
+    {   _workers.remove(name, pw);
+        if(pw->IsBusy())
+        {   // il termine sa requête puis s'arrête à la fermeture de son entrée
+            connect(pw, SIGNAL(finished(int,QProcess::ExitStatus)), pw, SLOT(deleteLater()));
+            pw->closeWriteChannel();
+        }
+        else
+        {   pw->disconnect(this);
+            pw->Close();
+            pw->deleteLater();
+        }
+    }
+    // -- le contenu de l'ancienne version n'est plus envoyé aux clients
+    QSet<QByteArray> hashes;
+    foreach (QString plugin, _registry->Names())
+    {   PluginInfo info;
+        if(_registry->Info(plugin, info)) hashes.insert(info.hash);
+    }
+    _cache.Retain(hashes);
+    // -- l'ancienne bibliothèque est déchargée à la fin de ses appels en cours
+    LibraryPlugin * plugin = _libraries.take(name);
+    if(plugin)
+    {   retireLibrary(plugin);
     }
-    // -- on attend la fin du processus
-    cp->waitForFinished();
+}
+
+void PluginManager::retireLibrary(LibraryPlugin *plugin)
+{
+    foreach (LibraryTask * task, _libraryTasks.keys())
+    {   if(task->GetPlugin() == plugin)
+        {   _retiredLibraries.insert(plugin);
+            return;
+        }
+    }
+    _retiredLibraries.remove(plugin);
+    plugin->Unload();
+    delete plugin;
+}
+
+void PluginManager::slot_workerRefused()
+{
+    PluginWorker * pw = qobject_cast<PluginWorker*>(sender());
+    if(!pw || !_workers.remove(pw->GetBin(), pw)) return;
+    LOG_INFO(QString("Plugin '%1' doesn't support worker mode, one process per operation will be used.").arg(pw->GetBin()));
+    _oneShotPlugins.insert(pw->GetBin());
+    // -- la requête soumise au worker est relancée dans un processus dédié, sa place est conservée
+    if(pw->IsBusy())
+    {   launch(pw->PendingCalculation(), pw->PendingOperation(), pw->PendingGroup());
+    }
+    pw->deleteLater();
 }
 
 void PluginManager::Slot_terminate()
 {   LOG_DEBUG("Slot_terminate() called.");
+    // -- drop pending operations
+    _pending.clear();
+    // -- stop all plugin workers
+    foreach (PluginWorker * pw, _workers)
+    {   pw->disconnect(this);
+        pw->Close();
+        delete pw;
+    }
+    _workers.clear();
+    // -- wait for library calls, their results are dropped
+    _libraryPool.clear();
+    _libraryPool.waitForDone();
+    QCoreApplication::removePostedEvents(this, QEvent::MetaCall);
+    qDeleteAll(_libraryTasks.keys());
+    _libraryTasks.clear();
+    qDeleteAll(_libraries);
+    _libraries.clear();
+    qDeleteAll(_retiredLibraries);
+    _retiredLibraries.clear();
+    _cache.Clear();
     // -- kill all pending processes
     while(!_processes.isEmpty())
     {   PluginProcess * cp = _processes.takeFirst();
+        cp->disconnect(this);
         cp->kill();
         cp->waitForFinished();
         delete cp;
     }
+    _running = 0;
     // -- emit sig_terminated
     LOG_DEBUG("sig_terminated() emitted.");
     emit sig_terminated();
@@ -153,6 +397,20 @@ void PluginManager::Slot_terminate()
 
 PluginManager::PluginManager() :
     _plugins_dir(),
-    _processes()
+    _registry(NULL),
+    _cache(),
+    _processes(),
+    _workers(),
+    _oneShotPlugins(),
+    _pending(),
+    _running(0),
+    _maxJobs(qMax(QThread::idealThreadCount(), 1)),
+    _splitPaused(false),
+    _libraryPool(),
+    _libraries(),
+    _libraryTasks(),
+    _retiredLibraries(),
+    _isolatePlugins(false)
 {
+    _libraryPool.setMaxThreadCount(_maxJobs);
 }
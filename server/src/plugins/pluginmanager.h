@@ -2,8 +2,16 @@
 #define PLUGINMANAGER_H
 
 #include "pluginprocess.h"
+#include "pluginworker.h"
+#include "librarytask.h"
+#include "pluginregistry.h"
+#include "plugincache.h"
 #include <QStringList>
 #include <QDir>
+#include <QMultiHash>
+#include <QQueue>
+#include <QSet>
+#include <QThreadPool>
 
 /**
  * @brief Cette classe gère les interactions avec les plugins
@@ -17,7 +25,7 @@ public:
      */
     bool Init();
     /**
-     * @brief Vérification de l'intégrité des plugins
+     * @brief Vérification de l'intégrité des plugins : chacun a été lu et son empreinte calculée
      * @return
      */
     bool CheckPlugins() const;
@@ -43,31 +51,79 @@ public:
      * @param calc
      */
     void Join(Calculation * calc);
+    /**
+     * @brief Lance la fusion partielle d'un groupe de résultats du calcul, pendant que d'autres
+     *      fragments sont encore calculés
+     * @param calc
+     * @param group
+     *      Identifiant du groupe de résultats à fusionner
+     */
+    void PartialJoin(Calculation * calc, int group);
     /**
      * @brief Lance la procédure de récupération de l'interface utilisateur
      * @param calc
      */
     void Ui(Calculation * calc);
     /**
-     * @brief Retourne le fichier sous forme d'un tableau d'octets pouvant être écrit dans le socket
+     * @brief Définit le nombre maximal d'opérations de plugin (fragmentation, fusion) exécutées
+     *      simultanément, les suivantes attendent qu'une place se libère
+     * @param jobs
+     *      Taille de l'exécuteur, au moins 1
+     */
+    void SetMaxJobs(int jobs);
+    /**
+     * @brief Exécute les plugins bibliothèque dans un processus hôte dédié plutôt que dans le
+     *      serveur : plus lent, mais un plugin qui plante ne fait pas tomber le serveur
+     * @param isolate
+     */
+    void SetIsolatePlugins(bool isolate);
+    /**
+     * @brief Retourne le contenu du plugin, pouvant être écrit dans le socket sans copie préalable
      * @param arch
      *      Architecture du client
      * @param os
      *      OS du client
      * @param bin
      *      Nom du binaire
-     * @warning la méthode appelante est chargée de libérer le tableau d'octets
-     * @return
+     * @return NULL si le plugin n'existe pas ou ne convient pas au client, le contenu reste
+     *      valide tant que la méthode appelante conserve le pointeur
+     */
+    MappedPluginPtr GetPluginData(const QString &arch, const QString &os, const QString &bin);
+    /**
+     * @brief Retourne l'empreinte SHA-256 du contenu d'un plugin, en hexadécimal
+     * @return une chaîne vide si le plugin n'existe pas
      */
-    const QByteArray * GetPluginData(const QString &arch, const QString &os, QString bin);
+    QString GetPluginHash(const QString & bin) const;
 
 private:
     /**
-     * @brief Démarre un nouveau processus pour un calcul
-     * @param program
-     * @param args
+     * @brief Place une opération sur un calcul dans la file de l'exécuteur
+     * @param calc
+     * @param op
+     */
+    void startCalcProcess(Calculation * calc, PluginProcess::CalculationOperation op, int group = -1);
+    /**
+     * @brief Lance les opérations en attente tant que l'exécuteur a des places libres
+     */
+    void schedule();
+    /**
+     * @brief Lance une opération dans un worker libre du plugin ou, à défaut, dans un nouveau processus
+     */
+    void launch(Calculation * calc, PluginProcess::CalculationOperation op, int group);
+    /**
+     * @brief Retourne un worker persistant libre du plugin, démarré au besoin
+     * @return NULL si le plugin ne supporte pas le mode worker
+     */
+    PluginWorker * worker(const QString & bin);
+    /**
+     * @brief Appelle l'opération d'un plugin bibliothèque dans le pool de threads, la
+     *      bibliothèque est chargée au premier appel
      */
-    void startCalcProcess(Calculation * calc, PluginProcess::CalculationOperation op);
+    void callLibrary(Calculation * calc, PluginProcess::CalculationOperation op, int group);
+    /**
+     * @brief Décharge une bibliothèque remplacée, ou la conserve jusqu'à la fin de ses appels
+     */
+    void retireLibrary(LibraryPlugin * plugin);
 
 signals:
     /**
@@ -84,6 +140,40 @@ public slots:
      */
     void Slot_terminate();
 
+    /**
+     * @brief Ce slot reçoit la taille de la file d'attente des fragments : les fragmentations en
+     *      flux sont suspendues quand elle est pleine et reprises quand elle se vide
+     * @param count
+     *      Nombre de fragments en attente d'un client
+     */
+    void Slot_waitingFragmentsUpdated(int count);
+
+private slots:
+    /**
+     * @brief Ce slot est appelé à la fin d'un processus de plugin
+     */
+    void slot_processDone();
+    /**
+     * @brief Ce slot libère une place de l'exécuteur et lance l'opération suivante
+     */
+    void slot_operationDone();
+    /**
+     * @brief Ce slot est appelé quand un plugin refuse le mode worker
+     */
+    void slot_workerRefused();
+    /**
+     * @brief Ce slot enregistre qu'un plugin supporte le mode worker
+     */
+    void slot_workerReady();
+    /**
+     * @brief Ce slot est appelé quand un plugin est ajouté, modifié ou retiré : les workers
+     *      et bibliothèques de l'ancienne version sont arrêtés sans redémarrer le serveur
+     */
+    void slot_pluginChanged(const QString & name);
+    /**
+     * @brief Ce slot transmet au calcul le résultat d'un appel de plugin bibliothèque
+     */
+    void slot_libraryDone();
 
 private: // singleton
     PluginManager();
@@ -93,10 +183,32 @@ private: // singleton
     friend class ApplicationManager;
     friend class CalculationManager;
     friend class Calculation;
+    friend class Fragment;
     friend class WorkingAboutToStartState;
 
     QDir _plugins_dir;
+    PluginRegistry * _registry;
+    PluginCache _cache;
     PluginProcessList _processes;
+    QMultiHash<QString, PluginWorker*> _workers;
+    QSet<QString> _oneShotPlugins;
+    /**
+     * @brief Opération de plugin en attente d'une place dans l'exécuteur
+     */
+    struct PendingOperation {
+        Calculation * calc;
+        PluginProcess::CalculationOperation op;
+        int group;
+    };
+    QQueue<PendingOperation> _pending;
+    int _running;
+    int _maxJobs;
+    bool _splitPaused;
+    QThreadPool _libraryPool;
+    QHash<QString, LibraryPlugin*> _libraries;
+    QHash<LibraryTask*, PendingOperation> _libraryTasks;
+    QSet<LibraryPlugin*> _retiredLibraries;
+    bool _isolatePlugins;
 };
 
 #endif // PLUGINMANAGER_H
@@ -0,0 +1,105 @@
+#include "pluginoutput.h"
+
+#include <limits>
+
+qint64 PluginOutput::_memoryLimit = OUTPUT_MEMORY_LIMIT_DEFAULT;
+
+PluginOutput::PluginOutput(bool percentEncoded) :
+    _decode(percentEncoded),
+    _pending(),
+    _memory(),
+    _file(NULL),
+    _map(NULL),
+    _size(0),
+    _ok(true)
+{
+}
+
+PluginOutput::~PluginOutput()
+{
+    if(_map)
+    {   _file->unmap(_map);
+    }
+    delete _file;
+}
+
+bool PluginOutput::Append(const QByteArray &data)
+{
+    if(!_decode)
+    {   return write(data);
+    }
+    // -- une séquence %XX peut être coupée entre deux morceaux : sa fin est attendue
+    QByteArray chunk = _pending + data;
+    int keep = 0;
+    if(chunk.endsWith('%'))
+    {   keep = 1;
+    }
+    else if(chunk.size() >= 2 && chunk.at(chunk.size() - 2) == '%')
+    {   keep = 2;
+    }
+    _pending = chunk.right(keep);
+    chunk.chop(keep);
+    return write(QByteArray::fromPercentEncoding(chunk));
+}
+
+QByteArray PluginOutput::Finish(bool &ok)
+{
+    if(!_pending.isEmpty())
+    {   write(_pending);
+        _pending.clear();
+    }
+    ok = _ok;
+    if(!_file || !_ok)
+    {   return _memory;
+    }
+    // -- un tableau ne peut pas dépasser 2 Go
+    if(_size > std::numeric_limits<int>::max())
+    {   ok = _ok = false;
+        return QByteArray();
+    }
+    // -- le fichier de débordement est lu par projection, sans copie
+    if(!_map && _size > 0)
+    {   _file->flush();
+        _map = _file->map(0, _size);
+        if(!_map)
+        {   ok = _ok = false;
+            return QByteArray();
+        }
+    }
+    return QByteArray::fromRawData((const char *)_map, (int)_size);
+}
+
+void PluginOutput::SetMemoryLimit(qint64 bytes)
+{
+    _memoryLimit = qMax(bytes, (qint64)0);
+}
+
+bool PluginOutput::spill()
+{
+    _file = new QTemporaryFile();
+    if(!_file->open() || _file->write(_memory) != _memory.size())
+    {   return false;
+    }
+    _memory = QByteArray(); // libère la mémoire
+    return true;
+}
+
+bool PluginOutput::write(const QByteArray &data)
+{
+    if(!_ok || data.isEmpty())
+    {   return _ok;
+    }
+    if(!_file && _memory.size() + data.size() > _memoryLimit)
+    {   _ok = spill();
+    }
+    if(_ok)
+    {   if(_file)
+        {   _ok = (_file->write(data) == data.size());
+        }
+        else
+        {   _memory.append(data);
+        }
+        _size += data.size();
+    }
+    return _ok;
+}
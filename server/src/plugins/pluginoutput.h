@@ -0,0 +1,68 @@
+#ifndef PLUGINOUTPUT_H
+#define PLUGINOUTPUT_H
+
+#include <QByteArray>
+#include <QTemporaryFile>
+
+#define OUTPUT_MEMORY_LIMIT_DEFAULT (16 * 1024 * 1024) // octets conservés en mémoire avant débordement sur disque
+
+/**
+ * @brief Cette classe accumule la sortie d'un plugin au fil de sa lecture : au delà de la limite
+ *      mémoire, le contenu déborde dans un fichier temporaire qui est projeté en mémoire à la fin.
+ *      La sortie peut être décodée (pourcentage) morceau par morceau, sans copie intermédiaire
+ */
+class PluginOutput
+{
+public:
+    /**
+     * @param percentEncoded
+     *      Vrai si la sortie du plugin est encodée en pourcentage et doit être décodée
+     */
+    PluginOutput(bool percentEncoded = false);
+    ~PluginOutput();
+    /**
+     * @brief Ajoute un morceau de la sortie
+     * @return faux si le fichier de débordement n'a pas pu être écrit
+     */
+    bool Append(const QByteArray & data);
+    /**
+     * @brief Termine la lecture de la sortie et retourne son contenu
+     * @param ok
+     *      Faux si le contenu n'a pas pu être écrit ou projeté
+     * @return le contenu de la sortie, sans copie s'il a débordé sur le disque
+     * @warning le tableau ne doit pas survivre à l'instance
+     */
+    QByteArray Finish(bool & ok);
+    /**
+     * @brief Retourne la taille du contenu déjà accumulé
+     */
+    inline qint64 Size() const { return _size; }
+    /**
+     * @brief Modifie la taille au delà de laquelle la sortie d'un plugin déborde sur le disque
+     * @param bytes
+     *      Taille en octets
+     */
+    static void SetMemoryLimit(qint64 bytes);
+
+private:
+    Q_DISABLE_COPY(PluginOutput)
+    /**
+     * @brief Écrit le contenu accumulé en mémoire dans un fichier temporaire
+     */
+    bool spill();
+    /**
+     * @brief Ajoute un morceau déjà décodé au contenu
+     */
+    bool write(const QByteArray & data);
+
+    bool _decode;
+    QByteArray _pending;
+    QByteArray _memory;
+    QTemporaryFile * _file;
+    uchar * _map;
+    qint64 _size;
+    bool _ok;
+    static qint64 _memoryLimit;
+};
+
+#endif // PLUGINOUTPUT_H
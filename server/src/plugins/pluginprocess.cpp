@@ -1,23 +1,44 @@
 #include "pluginprocess.h"
 #include "src/calculation/specs.h"
 #include "src/utils/logger.h"
+#include "libraryplugin.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QLibrary>
 
 #define JAR_EXT "jar"
+#define JAR_HOST_FILE "ptrs-jarhost.jar"
 #define SCRIPT_EXT() QStringList({"py","sh"})
 #define SCRIPT_INTERPRETER() QStringList({"python", "bash"})
+#define ERROR_TAIL_SIZE (64 * 1024) // octets de la sortie d'erreur conservés
 
-PluginProcess::PluginProcess(QString absExecDir, Calculation *calc, CalculationOperation op, QObject *parent) :
+PluginProcess::PluginProcess(QString absExecDir, Calculation *calc, CalculationOperation op, int group, QObject *parent) :
     QProcess(parent),
     _absExecDir(absExecDir),
     _calculation(calc),
     _fragment(NULL),
     _op(op),
-    _out(""),
-    _err("")
+    _group(group),
+    _output(),
+    _err(),
+    _formatKnown(false),
+    _streaming(false),
+    _paused(false),
+    _exited(false),
+    _abandoned(false)
 {
     // -- connexion du calcul aux évènements du processus
     connect(this, SIGNAL(error(QProcess::ProcessError)),      SLOT(Slot_error(QProcess::ProcessError)));
     connect(this, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(Slot_calcFinished(int,QProcess::ExitStatus)));
+    connect(this, SIGNAL(readyReadStandardError()),           SLOT(slot_readError()));
+    if(op == SPLIT)
+    {   connect(this, SIGNAL(readyReadStandardOutput()), SLOT(slot_readSplit()));
+    }
+    else
+    {   connect(this, SIGNAL(readyReadStandardOutput()), SLOT(slot_readOutput()));
+    }
 }
 
 PluginProcess::PluginProcess(QString absExecDir, Fragment *frag, QObject *parent) :
@@ -26,8 +47,14 @@ PluginProcess::PluginProcess(QString absExecDir, Fragment *frag, QObject *parent
     _calculation(NULL),
     _fragment(frag),
     _op(),
-    _out(""),
-    _err("")
+    _group(-1),
+    _output(),
+    _err(),
+    _formatKnown(false),
+    _streaming(false),
+    _paused(false),
+    _exited(false),
+    _abandoned(false)
 {
     // -- connexion du calcul aux évènements du processus
     connect(this, SIGNAL(error(QProcess::ProcessError)),      SLOT(Slot_error(QProcess::ProcessError)));
@@ -35,36 +62,92 @@ PluginProcess::PluginProcess(QString absExecDir, Fragment *frag, QObject *parent
 }
 
 bool PluginProcess::Start()
+{
+    QString command;
+    bool ok = Command(_absExecDir, _calculation->GetBin(), command);
+    // -- démarrage du plugin, la requête est écrite dans le tampon d'entrée en attendant le démarrage
+    if(ok)
+    {   start(command);
+        writeRequest();
+    }
+    // -- retour du statut
+    return ok;
+}
+
+void PluginProcess::writeRequest()
+{
+    QByteArray json;
+    write(Request(_calculation, _op, _group, json));
+    write(CS_CRLF);
+    if(!json.isEmpty())
+    {   write(json);
+        write(CS_CRLF);
+    }
+    write(CS_EOF);
+    write(CS_CRLF);
+}
+
+const char * PluginProcess::Request(Calculation *calc, CalculationOperation op, int group, QByteArray &json)
+{
+    switch (op) {
+    case SPLIT:
+        json = calc->ToJson().toUtf8(); // ici calc est supposé être un ensemble de fragments
+        return CS_OP_SPLIT;
+    case JOIN:
+        json = calc->FragmentsResultsToJson().toUtf8(); // ici calc est supposé contenir un ensemble de fragment
+        return CS_OP_JOIN;
+    case PARTIAL_JOIN:
+        json = calc->JoinGroupToJson(group).toUtf8();
+        return CS_OP_JOIN;
+    case UI:
+        json.clear();
+        return CS_OP_PARAM;
+    }
+    return NULL;
+}
+
+bool PluginProcess::Command(const QString & absExecDir, const QString & bin, QString & command)
 {
     // construction de la commande en fonction du type de binaire
-    QString command(_absExecDir);
+    command = absExecDir;
     // on ajoute le nom du binaire à la fin
-    command.append('/').append(_calculation->GetBin());
+    command.append('/').append(bin);
     // en fonction du type on effectue des opérations supplémentaires
     bool ok = true;
-    switch (DetectType(_calculation->GetBin())) {
+    switch (DetectType(bin)) {
     case BINARY: break;
     case JAR:
         command.prepend("java -jar ");
         break;
     case SCRIPT:
-        if(! selectInterpreter().isNull() )
-        {   command.prepend(selectInterpreter()).prepend(" ");
+        if(! selectInterpreter(bin).isNull() )
+        {   command.prepend(" ").prepend(selectInterpreter(bin));
         }
         else
         {   ok = false;
         }
         break;
+    case LIBRARY:
+        // la bibliothèque est chargée par une autre instance de l'application
+        command.prepend(" " OPT_PLUGIN_HOST " ").prepend(qApp->applicationFilePath());
+        break;
     }
-    // -- démarrage du plugin
-    if(ok)
-    {   // on exécute la commande trimmée pour éviter les espaces traitres
-        start(command.trimmed());
-    }
-    // -- retour du statut
+    // on trimme la commande pour éviter les espaces traitres
+    command = command.trimmed();
     return ok;
 }
 
+bool PluginProcess::WorkerCommand(const QString &absExecDir, const QString &bin, QString &command)
+{
+    // -- l'hôte JVM charge le plugin et reçoit ses opérations selon le protocole worker
+    QString host = QDir(qApp->applicationDirPath()).absoluteFilePath(JAR_HOST_FILE);
+    if(DetectType(bin) == JAR && QFile::exists(host))
+    {   command = QString("java -jar %1 %2/%3").arg(host).arg(absExecDir).arg(bin);
+        return true;
+    }
+    return Command(absExecDir, bin, command);
+}
+
 PluginProcess::Type PluginProcess::DetectType(const QString & bin)
 {
     Type type = BINARY;
@@ -76,12 +159,26 @@ PluginProcess::Type PluginProcess::DetectType(const QString & bin)
         else if(SCRIPT_EXT().contains(parts.last()))
         {   type = SCRIPT;
         }
+        else if(QLibrary::isLibrary(bin))
+        {   type = LIBRARY;
+        }
     }
     return type;
 }
 
+void PluginProcess::SetPaused(bool paused)
+{
+    _paused = paused;
+    if(!_paused && _streaming)
+    {   if(_exited) finishSplit();
+        else slot_readSplit();
+    }
+}
+
 void PluginProcess::Slot_error(QProcess::ProcessError error)
 {   LOG_DEBUG(QString("SLOT_ERROR(%1) called.").arg(error));
+    // une fragmentation abandonnée a été tuée volontairement
+    if(_abandoned) return;
     QString msg("");
     switch (error) {
     case QProcess::FailedToStart:
@@ -104,19 +201,36 @@ void PluginProcess::Slot_error(QProcess::ProcessError error)
         break;
     }
     _calculation->Crashed(msg);
+    // -- sans démarrage il n'y aura pas de signal finished()
+    if(error == QProcess::FailedToStart)
+    {   emit sig_done();
+    }
 }
 
 void PluginProcess::Slot_calcFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {   LOG_DEBUG(QString("SLOT_FINISHED(%1,%2) called.").arg(exitCode).arg(exitStatus));
+    if(_abandoned)
+    {   emit sig_done();
+        return;
+    }
     switch (exitStatus) {
     case QProcess::NormalExit:
         if(exitCode == 0)
         {   switch (_op) {
             case SPLIT:
-                _calculation->Splitted(readAllStandardOutput());
+                slot_readSplit();
+                if(_streaming)
+                {   // les dernières lignes peuvent attendre que la file d'attente se vide
+                    _exited = true;
+                    finishSplit();
+                    return;
+                }
+                finishOutput();
                 break;
             case JOIN:
-                _calculation->Joined(readAllStandardOutput());
+            case PARTIAL_JOIN:
+                slot_readOutput();
+                finishOutput();
                 break;
             case UI:
                 break; // là il ne se passe rien pour cette commande.
@@ -125,20 +239,109 @@ void PluginProcess::Slot_calcFinished(int exitCode, QProcess::ExitStatus exitSta
         else
         {   LOG_ERROR(QString("Process crashed (exit_code=%1).").arg(exitCode));
             // crash calculation
-            _calculation->Crashed(readAllStandardError());
+            slot_readError();
+            _calculation->Crashed(_err);
         }
         break;
     case QProcess::CrashExit:
         LOG_ERROR(QString("Process crashed (exit_code=%1).").arg(exitCode));
         // crash calculation
-        _calculation->Crashed(readAllStandardError());
+        slot_readError();
+        _calculation->Crashed(_err);
         break;
     }
+    emit sig_done();
 }
 
-QString PluginProcess::selectInterpreter()
+void PluginProcess::slot_readSplit()
 {
-    QStringList parts = _calculation->GetBin().split('.', QString::SkipEmptyParts);
+    // -- format détecté sur le premier caractère significatif de la sortie
+    if(!_formatKnown)
+    {   QByteArray head = peek(bytesAvailable()).trimmed();
+        if(head.isEmpty()) return;
+        _formatKnown = true;
+        _streaming = !head.startsWith('[');
+    }
+    // -- un tableau JSON n'est lu qu'à la fin, il est accumulé en attendant
+    if(!_streaming)
+    {   slot_readOutput();
+        return;
+    }
+    // -- un fragment par ligne, laissé dans le tampon du processus tant que la lecture est suspendue
+    while(_streaming && !_paused && !_abandoned && canReadLine())
+    {   QByteArray line = readLine().trimmed();
+        if(!line.isEmpty() && !_calculation->FragmentSplitted(line))
+        {   abandon();
+        }
+    }
+}
+
+void PluginProcess::slot_readOutput()
+{
+    _output.Append(readAllStandardOutput());
+}
+
+void PluginProcess::slot_readError()
+{
+    _err.append(readAllStandardError());
+    if(_err.size() > ERROR_TAIL_SIZE)
+    {   _err = _err.right(ERROR_TAIL_SIZE);
+    }
+}
+
+void PluginProcess::finishOutput()
+{
+    bool ok;
+    QByteArray out = _output.Finish(ok);
+    if(!ok)
+    {   _calculation->Crashed("can't store plugin output.");
+        return;
+    }
+    switch (_op) {
+    case SPLIT:
+        _calculation->Splitted(out);
+        break;
+    case JOIN:
+        _calculation->Joined(out);
+        break;
+    case PARTIAL_JOIN:
+        _calculation->PartialJoined(_group, out);
+        break;
+    case UI:
+        break;
+    }
+}
+
+void PluginProcess::finishSplit()
+{
+    slot_readSplit();
+    if(_paused || _abandoned) return;
+    // -- dernière ligne sans fin de ligne
+    QByteArray line = readAllStandardOutput().trimmed();
+    if(!line.isEmpty() && !_calculation->FragmentSplitted(line))
+    {   abandon();
+        return;
+    }
+    _streaming = false;
+    _calculation->SplitFinished();
+    emit sig_done();
+}
+
+void PluginProcess::abandon()
+{
+    LOG_DEBUG("Split abandoned, the calculation doesn't accept fragments anymore.");
+    _abandoned = true;
+    if(state() != QProcess::NotRunning)
+    {   kill();
+    }
+    else
+    {   emit sig_done();
+    }
+}
+
+QString PluginProcess::selectInterpreter(const QString & bin)
+{
+    QStringList parts = bin.split('.', QString::SkipEmptyParts);
     int index(-1);
     if(!parts.isEmpty())
     {   index = SCRIPT_EXT().indexOf(parts.last());
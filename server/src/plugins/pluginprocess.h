@@ -2,6 +2,7 @@
 #define PluginProcess_H
 
 #include "src/calculation/calculation.h"
+#include "pluginoutput.h"
 #include <QProcess>
 
 class PluginProcess : public QProcess
@@ -15,6 +16,7 @@ public:
     enum CalculationOperation {
         SPLIT,  ///< Opération de fragmentation d'un calcul
         JOIN,   ///< Opération d'aggrégation des résultats
+        PARTIAL_JOIN, ///< Opération d'aggrégation d'un groupe de résultats, en cours de calcul
         UI      ///< Opération de récupération de la description de l'interface utilisateur
     };
     /**
@@ -24,7 +26,8 @@ public:
     enum Type {
         BINARY,     ///< Binaire compilé
         JAR,        ///< Archive JAR java
-        SCRIPT      ///< Fichier script avec interpréteur sans #!/bin/... sinon considéré comme binaire
+        SCRIPT,     ///< Fichier script avec interpréteur sans #!/bin/... sinon considéré comme binaire
+        LIBRARY     ///< Bibliothèque partagée implémentant l'interface de pluginabi.h
     };
     /**
      * @brief Construit une nouvelle instance de processus sur un calcul
@@ -32,21 +35,59 @@ public:
      *      Calcul auquel le processus est lié
      * @param op
      *      Opération réalisée par le plugin sur le calcul passé en paramètre
+     * @param group
+     *      Groupe de résultats à fusionner pour l'opération PARTIAL_JOIN
      */
-    PluginProcess(QString absExecDir, Calculation * calc, CalculationOperation op, QObject * parent = NULL);
+    PluginProcess(QString absExecDir, Calculation * calc, CalculationOperation op, int group = -1, QObject * parent = NULL);
     PluginProcess(QString absExecDir, Fragment *calc, QObject *parent = NULL);
     ~PluginProcess(){} //do not delete calc here
     /**
-     * @brief Démarre l'exécution du plugin
+     * @brief Démarre l'exécution du plugin et lui écrit sa requête, sans attendre le résultat
      * @return retourne faux si aucun n'interpréteur n'a été trouvé pour le type script, sinon retourne toujours vrai
      */
     bool Start();
     /**
-     * @brief Détecte le type de plugin (binaire compilé, JAR, script)
+     * @brief Détecte le type de plugin (binaire compilé, JAR, script, bibliothèque)
      *          Pour l'instant on se contente de regarder l'extension
      * @return le type de plugin
      */
     static Type DetectType(const QString & bin);
+    /**
+     * @brief Construit la commande de lancement d'un plugin en fonction de son type
+     * @param absExecDir
+     *      Répertoire des plugins
+     * @param bin
+     *      Nom du binaire du plugin
+     * @param command
+     *      Commande construite
+     * @return faux si aucun interpréteur n'a été trouvé pour le type script
+     */
+    static bool Command(const QString & absExecDir, const QString & bin, QString & command);
+    /**
+     * @brief Construit la commande de lancement d'un plugin en mode worker : un plugin JAR est
+     *      chargé une fois pour toutes dans l'hôte JVM résident, s'il est installé à côté de
+     *      l'application
+     * @see Command()
+     */
+    static bool WorkerCommand(const QString & absExecDir, const QString & bin, QString & command);
+    /**
+     * @brief Construit la requête d'une opération sur un calcul
+     * @param json
+     *      Requête JSON, vide pour l'opération UI
+     * @return nom de l'opération transmis au plugin
+     */
+    static const char * Request(Calculation * calc, CalculationOperation op, int group, QByteArray & json);
+    /**
+     * @brief Suspend ou reprend la lecture des fragments d'une fragmentation en flux : les lignes
+     *      non lues restent dans le tampon du processus tant que la file d'attente est pleine
+     */
+    void SetPaused(bool paused);
+
+signals:
+    /**
+     * @brief Ce signal est émis quand l'opération est terminée, avec ou sans succès
+     */
+    void sig_done();
 
 private slots:
     /**
@@ -64,16 +105,52 @@ private slots:
      *      Satut de fin du processus
      */
     void Slot_calcFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    /**
+     * @brief Ce slot lit la sortie d'une fragmentation au fil de l'eau : en NDJSON (un fragment
+     *      par ligne) chaque fragment est planifié dès sa lecture, un tableau JSON est lu à la fin
+     */
+    void slot_readSplit();
+    /**
+     * @brief Ce slot accumule la sortie du plugin au fil de l'eau, sans la laisser grossir
+     *      dans le tampon du processus
+     */
+    void slot_readOutput();
+    /**
+     * @brief Ce slot lit la sortie d'erreur au fil de l'eau, seule sa fin est conservée
+     */
+    void slot_readError();
 
 private:
-    QString selectInterpreter();
+    /**
+     * @brief Écrit la requête correspondant à l'opération sur l'entrée standard du plugin
+     */
+    void writeRequest();
+    /**
+     * @brief Termine une fragmentation en flux une fois toutes ses lignes transmises au calcul
+     */
+    void finishSplit();
+    /**
+     * @brief Abandonne une fragmentation dont le calcul ne veut plus de fragments
+     */
+    void abandon();
+    /**
+     * @brief Termine la lecture de la sortie et transmet son contenu au calcul
+     */
+    void finishOutput();
+    static QString selectInterpreter(const QString & bin);
 
     QString _absExecDir;
     Calculation * _calculation;
     Fragment * _fragment;
     CalculationOperation _op;
-    QString _out;
-    QString _err;
+    int _group;
+    PluginOutput _output;
+    QByteArray _err;
+    bool _formatKnown;
+    bool _streaming;
+    bool _paused;
+    bool _exited;
+    bool _abandoned;
 };
 
 typedef QList<PluginProcess*> PluginProcessList;
@@ -0,0 +1,180 @@
+#include "pluginregistry.h"
+#include "src/utils/logger.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+
+#define REFRESH_DELAY 500 // ms, laisse à la copie d'un plugin le temps de se terminer
+
+PluginRegistry::PluginRegistry(QObject *parent) :
+    QObject(parent),
+    _dir(),
+    _plugins(),
+    _names(),
+    _lock(),
+    _watcher(),
+    _changed(),
+    _refreshTimer()
+{
+    _refreshTimer.setSingleShot(true);
+    _refreshTimer.setInterval(REFRESH_DELAY);
+    connect(&_refreshTimer, SIGNAL(timeout()), SLOT(slot_refresh()));
+    connect(&_watcher, SIGNAL(directoryChanged(QString)), SLOT(slot_directoryChanged()));
+    connect(&_watcher, SIGNAL(fileChanged(QString)),      SLOT(slot_fileChanged(QString)));
+}
+
+bool PluginRegistry::Init(const QDir &dir)
+{
+    bool ok = true;
+    _dir = dir;
+    // -- lecture initiale du répertoire
+    QHash<QString, PluginInfo> plugins;
+    foreach (QString name, _dir.entryList(QDir::Files, QDir::Name))
+    {   PluginInfo info;
+        if(read(name, info))
+        {   plugins.insert(name, info);
+        }
+        else
+        {   LOG_ERROR(QString("Can't read plugin '%1' !").arg(name));
+            ok = false;
+        }
+    }
+    QStringList names = plugins.keys();
+    names.sort();
+    {   QWriteLocker locker(&_lock);
+        _plugins = plugins;
+        _names = names;
+    }
+    // -- surveillance du répertoire (ajouts, suppressions) et des plugins (modifications)
+    _watcher.addPath(_dir.absolutePath());
+    foreach (QString name, names)
+    {   _watcher.addPath(_dir.absoluteFilePath(name));
+    }
+    return ok;
+}
+
+bool PluginRegistry::Contains(const QString &name) const
+{
+    QReadLocker locker(&_lock);
+    return _plugins.contains(name);
+}
+
+bool PluginRegistry::Info(const QString &name, PluginInfo &info) const
+{
+    QReadLocker locker(&_lock);
+    QHash<QString, PluginInfo>::const_iterator it = _plugins.constFind(name);
+    if(it == _plugins.constEnd())
+    {   return false;
+    }
+    info = it.value();
+    return true;
+}
+
+QStringList PluginRegistry::Names() const
+{
+    QReadLocker locker(&_lock);
+    return _names;
+}
+
+void PluginRegistry::DeclareCapability(const QString &name, const QString &capability)
+{
+    QWriteLocker locker(&_lock);
+    QHash<QString, PluginInfo>::iterator it = _plugins.find(name);
+    if(it != _plugins.end() && !it.value().capabilities.contains(capability))
+    {   it.value().capabilities.append(capability);
+    }
+}
+
+void PluginRegistry::slot_directoryChanged()
+{
+    QSet<QString> current = _dir.entryList(QDir::Files, QDir::Name).toSet();
+    QSet<QString> known = Names().toSet();
+    // -- plugins ajoutés ou retirés
+    _changed += current - known;
+    _changed += known - current;
+    // -- un plugin remplacé par un nouveau fichier n'est plus surveillé
+    QStringList watched = _watcher.files();
+    foreach (QString name, current & known)
+    {   if(!watched.contains(_dir.absoluteFilePath(name)))
+        {   _changed.insert(name);
+        }
+    }
+    _refreshTimer.start();
+}
+
+void PluginRegistry::slot_fileChanged(const QString &path)
+{
+    _changed.insert(QFileInfo(path).fileName());
+    _refreshTimer.start();
+}
+
+void PluginRegistry::slot_refresh()
+{
+    QSet<QString> changed = _changed;
+    _changed.clear();
+    foreach (QString name, changed)
+    {   refresh(name);
+    }
+}
+
+bool PluginRegistry::read(const QString &name, PluginInfo &info) const
+{
+    QFile file(_dir.absoluteFilePath(name));
+    if(!file.open(QIODevice::ReadOnly))
+    {   return false;
+    }
+    QFileInfo fileInfo(file);
+    info.name = name;
+    info.type = PluginProcess::DetectType(name);
+    info.size = fileInfo.size();
+    info.modified = fileInfo.lastModified();
+    info.capabilities.clear();
+    // -- empreinte du contenu, lue par blocs
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if(!hash.addData(&file))
+    {   return false;
+    }
+    info.hash = hash.result().toHex();
+    return true;
+}
+
+void PluginRegistry::refresh(const QString &name)
+{
+    QString path = _dir.absoluteFilePath(name);
+    PluginInfo current;
+    bool known = Info(name, current);
+    PluginInfo info;
+    if(!read(name, info))
+    {   // -- le plugin a disparu (ou n'est plus lisible)
+        if(known)
+        {   {   QWriteLocker locker(&_lock);
+                _plugins.remove(name);
+                _names.removeOne(name);
+            }
+            _watcher.removePath(path);
+            LOG_INFO(QString("Plugin '%1' removed.").arg(name));
+            emit sig_pluginRemoved(name);
+        }
+        return;
+    }
+    if(!_watcher.files().contains(path))
+    {   _watcher.addPath(path);
+    }
+    // -- contenu inchangé : les capacités annoncées restent valables
+    bool updated = !known || info.hash != current.hash;
+    if(!updated)
+    {   info.capabilities = current.capabilities;
+    }
+    {   QWriteLocker locker(&_lock);
+        _plugins.insert(name, info);
+        if(!known)
+        {   _names.append(name);
+            _names.sort();
+        }
+    }
+    if(updated)
+    {   LOG_INFO(QString("Plugin '%1' %2.").arg(name).arg(known ? "updated" : "added"));
+        emit sig_pluginUpdated(name);
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef PLUGINREGISTRY_H
+#define PLUGINREGISTRY_H
+
+#include "pluginprocess.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+#define CAPABILITY_WORKER "worker" // le plugin a annoncé le mode worker
+
+/**
+ * @brief Cette structure décrit un plugin du répertoire des plugins
+ */
+struct PluginInfo {
+    QString name;                   ///< Nom du fichier du plugin
+    PluginProcess::Type type;       ///< Type du plugin
+    qint64 size;                    ///< Taille du fichier en octets
+    QDateTime modified;             ///< Date de dernière modification du fichier
+    QByteArray hash;                ///< Empreinte SHA-256 du contenu, en hexadécimal
+    QStringList capabilities;       ///< Capacités annoncées par le plugin depuis son dernier changement
+};
+
+/**
+ * @brief Cette classe tient à jour la liste des plugins disponibles : le répertoire est lu une
+ *      fois puis surveillé, chaque recherche se fait en mémoire. Les accès en lecture peuvent
+ *      venir de n'importe quel thread, la surveillance a lieu dans le thread de l'instance
+ */
+class PluginRegistry : public QObject
+{
+    Q_OBJECT
+public:
+    PluginRegistry(QObject * parent = NULL);
+    ~PluginRegistry(){}
+    /**
+     * @brief Lit le répertoire des plugins et commence à le surveiller
+     * @param dir
+     *      Répertoire des plugins
+     * @return faux si l'empreinte d'un plugin n'a pas pu être calculée
+     */
+    bool Init(const QDir & dir);
+    /**
+     * @brief Vérification de l'existence d'un plugin
+     */
+    bool Contains(const QString & name) const;
+    /**
+     * @brief Retourne la description d'un plugin
+     * @param info
+     *      Description du plugin
+     * @return faux si le plugin n'existe pas
+     */
+    bool Info(const QString & name, PluginInfo & info) const;
+    /**
+     * @brief Retourne le nom des plugins, triés par ordre alphabétique
+     */
+    QStringList Names() const;
+    /**
+     * @brief Enregistre une capacité annoncée par un plugin, oubliée s'il est modifié
+     */
+    void DeclareCapability(const QString & name, const QString & capability);
+
+signals:
+    /**
+     * @brief Ce signal est émis quand un plugin apparaît ou que son contenu change
+     */
+    void sig_pluginUpdated(const QString & name);
+    /**
+     * @brief Ce signal est émis quand un plugin disparaît du répertoire
+     */
+    void sig_pluginRemoved(const QString & name);
+
+private slots:
+    /**
+     * @brief Ce slot est appelé quand un fichier est ajouté ou retiré du répertoire
+     */
+    void slot_directoryChanged();
+    /**
+     * @brief Ce slot est appelé quand un plugin est modifié
+     */
+    void slot_fileChanged(const QString & path);
+    /**
+     * @brief Ce slot met à jour les plugins modifiés, une fois leur écriture terminée
+     */
+    void slot_refresh();
+
+private:
+    /**
+     * @brief Lit la description d'un plugin sur le disque et calcule son empreinte
+     * @return faux si le fichier ne peut pas être lu
+     */
+    bool read(const QString & name, PluginInfo & info) const;
+    /**
+     * @brief Met à jour la description d'un plugin et émet le signal correspondant
+     */
+    void refresh(const QString & name);
+
+    QDir _dir;
+    QHash<QString, PluginInfo> _plugins;
+    QStringList _names;
+    mutable QReadWriteLock _lock;
+    QFileSystemWatcher _watcher;
+    QSet<QString> _changed;
+    QTimer _refreshTimer;
+};
+
+#endif // PLUGINREGISTRY_H
@@ -0,0 +1,159 @@
+#include "pluginworker.h"
+#include "src/calculation/specs.h"
+#include "src/utils/logger.h"
+
+PluginWorker::PluginWorker(const QString &bin, QObject *parent) :
+    QProcess(parent),
+    _bin(bin),
+    _calculation(NULL),
+    _op(PluginProcess::SPLIT),
+    _group(-1),
+    _buffer(),
+    _expected(-1),
+    _ok(false),
+    _ready(false),
+    _refused(false),
+    _helloTimer()
+{
+    _helloTimer.setSingleShot(true);
+    connect(&_helloTimer, SIGNAL(timeout()), SLOT(slot_helloTimeout()));
+    connect(this, SIGNAL(readyReadStandardOutput()),          SLOT(slot_readOutput()));
+    connect(this, SIGNAL(error(QProcess::ProcessError)),      SLOT(slot_error(QProcess::ProcessError)));
+    connect(this, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(slot_finished(int,QProcess::ExitStatus)));
+}
+
+void PluginWorker::Start(const QString &command, int timeout)
+{
+    start(command);
+    // -- demande du mode worker : un plugin qui l'ignore échoue sur cette opération inconnue
+    write(CS_OP_WORKER);
+    write(CS_CRLF);
+    write(CS_EOF);
+    write(CS_CRLF);
+    _helloTimer.start(timeout);
+}
+
+void PluginWorker::Submit(Calculation *calc, PluginProcess::CalculationOperation op, int group)
+{
+    QByteArray json;
+    const char * name = PluginProcess::Request(calc, op, group, json);
+    _calculation = calc;
+    _op = op;
+    _group = group;
+    write(QString("%1 %2").arg(name).arg(json.size()).toUtf8());
+    write(CS_CRLF);
+    write(json);
+}
+
+void PluginWorker::Close()
+{
+    _helloTimer.stop();
+    closeWriteChannel();
+    if(!waitForFinished(1000))
+    {   kill();
+        waitForFinished();
+    }
+}
+
+void PluginWorker::slot_readOutput()
+{
+    _buffer.append(readAllStandardOutput());
+    forever
+    {   // -- en-tête de réponse, les autres lignes sont ignorées
+        if(_expected < 0)
+        {   int eol = _buffer.indexOf('\n');
+            if(eol < 0) return;
+            QByteArray line = _buffer.left(eol).trimmed();
+            _buffer.remove(0, eol + 1);
+            // --- la première ligne doit être l'annonce du protocole
+            if(!_ready)
+            {   if(line != CS_WORKER_HELLO)
+                {   refuse();
+                    return;
+                }
+                _helloTimer.stop();
+                _ready = true;
+                LOG_INFO(QString("Plugin '%1' started in worker mode.").arg(_bin));
+                emit sig_ready();
+                continue;
+            }
+            QList<QByteArray> header = line.split(' ');
+            bool ok = header.size() == 2 && (header.at(0) == CS_WORKER_OK || header.at(0) == CS_WORKER_KO);
+            int size = ok ? header.at(1).toInt(&ok) : -1;
+            if(!ok || size < 0)
+            {   LOG_DEBUG(QString("Worker output ignored : '%1'").arg(QString(line)));
+                continue;
+            }
+            _ok = header.at(0) == CS_WORKER_OK;
+            _expected = size;
+        }
+        // -- corps de la réponse
+        if(_buffer.size() < _expected) return;
+        QByteArray payload = _buffer.left(_expected);
+        _buffer.remove(0, _expected);
+        _expected = -1;
+        respond(_ok, payload);
+    }
+}
+
+void PluginWorker::slot_finished(int exitCode, QProcess::ExitStatus exitStatus)
+{   LOG_DEBUG(QString("Worker finished(%1,%2).").arg(exitCode).arg(exitStatus));
+    if(!_ready)
+    {   refuse();
+    }
+    else if(IsBusy())
+    {   LOG_ERROR(QString("Plugin worker exited during a request (exit_code=%1).").arg(exitCode));
+        respond(false, readAllStandardError());
+    }
+}
+
+void PluginWorker::slot_error(QProcess::ProcessError error)
+{
+    // -- sans démarrage il n'y aura pas de signal finished()
+    if(error == QProcess::FailedToStart)
+    {   refuse();
+    }
+}
+
+void PluginWorker::slot_helloTimeout()
+{
+    refuse();
+}
+
+void PluginWorker::respond(bool ok, const QByteArray &payload)
+{
+    // le worker est libéré avant de rendre la main au calcul, qui peut soumettre une autre requête
+    Calculation * calc = _calculation;
+    _calculation = NULL;
+    if(!calc) return;
+    if(!ok)
+    {   calc->Crashed(payload);
+    }
+    else
+    {   switch (_op) {
+        case PluginProcess::SPLIT:
+            calc->Splitted(payload);
+            break;
+        case PluginProcess::JOIN:
+            calc->Joined(payload);
+            break;
+        case PluginProcess::PARTIAL_JOIN:
+            calc->PartialJoined(_group, payload);
+            break;
+        case PluginProcess::UI:
+            break; // là il ne se passe rien pour cette commande.
+        }
+    }
+    emit sig_done();
+}
+
+void PluginWorker::refuse()
+{
+    if(_refused) return;
+    _refused = true;
+    _helloTimer.stop();
+    if(state() != QProcess::NotRunning)
+    {   kill();
+    }
+    emit sig_refused();
+}
@@ -0,0 +1,115 @@
+#ifndef PLUGINWORKER_H
+#define PLUGINWORKER_H
+
+#include "pluginprocess.h"
+
+#include <QTimer>
+
+/**
+ * @brief Cette classe représente un plugin lancé une seule fois en mode worker : le processus
+ *      reste en vie et traite les requêtes qui lui sont soumises les unes après les autres.
+ *
+ *      Une requête est une ligne "<op> <taille>" suivie de taille octets de JSON, une réponse
+ *      une ligne "OK <taille>" ou "KO <taille>" suivie du résultat ou du message d'erreur.
+ */
+class PluginWorker : public QProcess
+{
+    Q_OBJECT
+public:
+    PluginWorker(const QString & bin, QObject * parent = NULL);
+    ~PluginWorker(){} //do not delete calc here
+    /**
+     * @brief Démarre le plugin en mode worker, sans attendre qu'il annonce le protocole :
+     *      sig_refused() est émis s'il ne l'a pas fait dans le délai imparti
+     * @param command
+     *      Commande de lancement du plugin
+     * @param timeout
+     *      Délai maximal d'attente de l'annonce en millisecondes
+     */
+    void Start(const QString & command, int timeout);
+    /**
+     * @brief Soumet une opération sur un calcul au worker, éventuellement avant son annonce.
+     *      Le résultat est transmis au calcul à réception de la réponse, puis sig_done() est émis
+     */
+    void Submit(Calculation * calc, PluginProcess::CalculationOperation op, int group = -1);
+    /**
+     * @brief Indique si une requête est en cours de traitement
+     */
+    bool IsBusy() const { return _calculation != NULL; }
+    /**
+     * @brief Retourne le nom du plugin exécuté par ce worker
+     */
+    inline QString GetBin() const { return _bin; }
+    /**
+     * @brief Retourne le calcul de la requête en cours, NULL si le worker est libre
+     */
+    inline Calculation * PendingCalculation() const { return _calculation; }
+    /**
+     * @brief Retourne l'opération de la requête en cours
+     */
+    inline PluginProcess::CalculationOperation PendingOperation() const { return _op; }
+    /**
+     * @brief Retourne le groupe de résultats de la requête en cours (opération PARTIAL_JOIN)
+     */
+    inline int PendingGroup() const { return _group; }
+    /**
+     * @brief Ferme l'entrée du worker et attend sa fin, le tue au besoin
+     */
+    void Close();
+
+signals:
+    /**
+     * @brief Ce signal est émis quand le plugin a annoncé le mode worker
+     */
+    void sig_ready();
+    /**
+     * @brief Ce signal est émis quand la réponse à une requête a été transmise au calcul
+     */
+    void sig_done();
+    /**
+     * @brief Ce signal est émis quand le plugin ne supporte pas le mode worker, la requête
+     *      en cours éventuelle n'a alors pas été traitée
+     */
+    void sig_refused();
+
+private slots:
+    /**
+     * @brief Ce slot lit la sortie du worker au fil de l'eau et découpe les réponses
+     */
+    void slot_readOutput();
+    /**
+     * @brief Ce slot est appelé quand le processus du worker se termine
+     */
+    void slot_finished(int exitCode, QProcess::ExitStatus exitStatus);
+    /**
+     * @brief Ce slot est appelé en cas d'erreur du processus
+     */
+    void slot_error(QProcess::ProcessError error);
+    /**
+     * @brief Ce slot est appelé quand le plugin n'a pas annoncé le protocole à temps
+     */
+    void slot_helloTimeout();
+
+private:
+    /**
+     * @brief Transmet la réponse au calcul de la requête en cours
+     */
+    void respond(bool ok, const QByteArray & payload);
+    /**
+     * @brief Abandonne le mode worker pour ce plugin
+     */
+    void refuse();
+
+    QString _bin;
+    Calculation * _calculation;
+    PluginProcess::CalculationOperation _op;
+    int _group;
+    QByteArray _buffer;
+    int _expected;
+    bool _ok;
+    bool _ready;
+    bool _refused;
+    QTimer _helloTimer;
+};
+
+#endif // PLUGINWORKER_H
@@ -0,0 +1,18 @@
+#!/bin/bash
+# Plugin de test : un seul fragment, dont le calcul ne se termine jamais et n'écrit aucun PROGRESS
+read action
+while read line && [ "$line" != "EOF" ]; do :; done
+case "$action" in
+    split)
+        echo '[{"bin":"hang.sh","params":{},"estimate":1}]'
+        ;;
+    calc)
+        while :; do sleep 1; done
+        ;;
+    join)
+        echo '{}'
+        ;;
+    *)
+        exit 1
+        ;;
+esac
@@ -0,0 +1,40 @@
+#!/bin/bash
+# Scénario : le serveur (bail minimal d'une minute, le plugin estimant son fragment à une
+# seconde) et un client déployés par 'make deploy', le plugin hang.sh bloque le calcul
+BIN=../../../bin
+TIMEOUT=150 # s, le bail expire au bout d'une minute
+TMP=`mktemp -d`
+mkdir -p $TMP/server/plugins $TMP/client
+cp $BIN/server $TMP/server/ && cp $BIN/qt_client $TMP/client/ || exit 1
+cp hang.sh $TMP/server/plugins/
+mkfifo $TMP/console
+
+# attend qu'une ligne apparaisse dans le journal du serveur
+wait_log()
+{
+    for i in `seq $TIMEOUT`; do
+        grep -q "$1" $TMP/server/server.log && return 0
+        sleep 1
+    done
+    return 1
+}
+
+(cd $TMP/server && exec timeout $TIMEOUT ./server < $TMP/console > /dev/null 2> server.log) &
+SERVER=$!
+exec 3> $TMP/console
+(cd $TMP/client && exec timeout $TIMEOUT ./qt_client < /dev/null > /dev/null 2> client.log) &
+CLIENT=$!
+
+wait_log "Démarrage du console handler"
+echo 'EXEC {"bin":"hang.sh","params":{}}' >&3
+wait_log "Lease of fragment .* expired" && echo "lease expired"
+wait_log "Fragment is getting reaffected" && echo "fragment requeued"
+echo 'SHUTDOWN' >&3
+exec 3>&-
+
+wait $SERVER
+kill $CLIENT 2> /dev/null
+wait $CLIENT 2> /dev/null
+pkill -f "$TMP" 2> /dev/null
+rm -rf $TMP
+exit 0